@@ -0,0 +1,288 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file actionBench.cc
+/// \brief Microbenchmark of the user-action hot paths
+//
+// Usage: actionBench [calls]
+//
+// Drives the hot paths of the application outside of a run, on a world
+// with one box per detector of B2b::DetectorConstruction and synthetic
+// steps, and prints the time and the heap allocations (calls of the global
+// operator new) per call:
+//   TrackerSD::ProcessHits       neutron steps, 10 tracks of 10 steps per
+//                                event, in step and in track hit mode,
+//                                and rejected proton steps; includes the
+//                                Initialize() and deletion of the hits
+//                                collection of each event
+//   TrackerHit                   new and delete
+//   EventAction                  BeginOfEventAction() and
+//                                EndOfEventAction() of an event with 5
+//                                hits in each detector
+//   GeneratePrimaries            one event with one primary, including
+//                                the construction of the G4Event
+// The event action runs calls/100 times; its histograms and ntuple rows
+// are written to actionBench_*.csv.
+
+#include "DetectorRegistry.hh"
+#include "EventAction.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "RunAction.hh"
+#include "TallyManager.hh"
+#include "TrackerHit.hh"
+#include "TrackerSD.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4Box.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Event.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Navigator.hh"
+#include "G4Neutron.hh"
+#include "G4NistManager.hh"
+#include "G4PVPlacement.hh"
+#include "G4Proton.hh"
+#include "G4SDManager.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Track.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace
+{
+
+std::size_t gAllocations = 0;
+
+struct Volume
+{
+  const char* name;
+  G4int number;
+  const char* spectrumName;
+};
+
+// The sensitive volumes of B2b::DetectorConstruction
+const Volume kVolumes[] = { { "Moderator", 1, "EMod" },
+                            { "BertholdGas", 3, "E" },
+                            { "Scorer1", 4, "ES1" } };
+
+const G4int kTracksPerEvent = 10;
+const G4int kStepsPerTrack = 10;
+const G4int kHitsPerDetector = 5;
+
+struct Detector
+{
+  B2::TrackerSD* sd = nullptr;
+  G4TouchableHandle touchable;
+  G4ThreeVector position;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <class F>
+void Measure(const char* name, long calls, long callsPerIteration, F iteration)
+{
+  // The first iteration fills the allocator pools and caches
+  iteration();
+  long iterations = std::max(1L, calls / callsPerIteration);
+  std::size_t allocations = gAllocations;
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < iterations; ++i) iteration();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  double n = double(iterations) * callsPerIteration;
+  std::printf("%-42s %12.1f %14.3f %12ld\n", name, elapsed.count() / n * 1.e9,
+              (gAllocations - allocations) / n, long(n));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// One step of a track through the volume of the detector
+void SetStep(G4Step& step, G4Track& track, const Detector& detector)
+{
+  auto preStepPoint = step.GetPreStepPoint();
+  preStepPoint->SetTouchableHandle(detector.touchable);
+  preStepPoint->SetPosition(detector.position);
+  preStepPoint->SetKineticEnergy(track.GetKineticEnergy());
+  auto postStepPoint = step.GetPostStepPoint();
+  postStepPoint->SetTouchableHandle(detector.touchable);
+  postStepPoint->SetPosition(detector.position + G4ThreeVector(0., 0., 1. * mm));
+  postStepPoint->SetKineticEnergy(0.9 * track.GetKineticEnergy());
+  step.SetTotalEnergyDeposit(10. * keV);
+  step.SetStepLength(1. * mm);
+  step.SetTrack(&track);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Steps of kTracksPerEvent tracks of kStepsPerTrack steps into the detector
+void ProcessHits(const Detector& detector, G4Step& step, G4Track& track)
+{
+  for (G4int i = 0; i < kTracksPerEvent * kStepsPerTrack; ++i) {
+    track.SetTrackID(1 + i / kStepsPerTrack);
+    detector.sd->ProcessHits(&step, nullptr);
+  }
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void* operator new(std::size_t size)
+{
+  ++gAllocations;
+  if (void* p = std::malloc(size ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  long calls = argc > 1 ? std::atol(argv[1]) : 1000000;
+  if (calls <= 0) {
+    std::fprintf(stderr, "Usage: %s [calls]\n", argv[0]);
+    return 1;
+  }
+
+  // World with the detector boxes along the beam
+  G4Material* air = G4NistManager::Instance()->FindOrBuildMaterial("G4_AIR");
+  auto worldLV = new G4LogicalVolume(new G4Box("World", 1. * m, 1. * m, 1. * m), air, "World");
+  auto worldPV = new G4PVPlacement(nullptr, G4ThreeVector(), worldLV, "World", nullptr,
+                                   false, 0);
+  G4Navigator navigator;
+  navigator.SetWorldVolume(worldPV);
+
+  G4Neutron::Definition();
+  G4Proton::Definition();
+
+  auto sdManager = G4SDManager::GetSDMpointer();
+  auto registry = B2::DetectorRegistry::Instance();
+  std::vector<Detector> detectors;
+  for (const auto& volume : kVolumes) {
+    Detector detector;
+    detector.position = G4ThreeVector(0., 0., (20. * detectors.size() - 20.) * cm);
+    G4String name = volume.name;
+    auto logical = new G4LogicalVolume(new G4Box(name + "Box", 10. * cm, 10. * cm, 5. * cm),
+                                       air, name + "LV");
+    new G4PVPlacement(nullptr, detector.position, logical, name, worldLV, false, 0);
+
+    B2::TallyManager::Instance()->AddTally(name);
+    G4String collection = name + "HitsCollection";
+    detector.sd = new B2::TrackerSD(name + "SD", collection, volume.number);
+    sdManager->AddNewDetector(detector.sd);
+    logical->SetSensitiveDetector(detector.sd);
+    registry->Register(name, volume.number, volume.spectrumName,
+                       sdManager->GetCollectionID(collection));
+    detectors.push_back(detector);
+  }
+  for (auto& detector : detectors) {
+    navigator.LocateGlobalPointAndSetup(detector.position, nullptr, false, true);
+    detector.touchable = navigator.CreateTouchableHistoryHandle();
+  }
+  G4int capacity = sdManager->GetCollectionCapacity();
+
+  // Histograms, ntuple and tallies as at the start of a run
+  auto analysisManager = G4AnalysisManager::Instance();
+  analysisManager->SetVerboseLevel(0);
+  B2::RunAction::Book();
+  analysisManager->OpenFile("actionBench.csv");
+  registry->ResolveHistograms();
+  B2::TallyManager::Instance()->BeginOfRun();
+
+  G4Track neutron(new G4DynamicParticle(G4Neutron::Definition(), G4ThreeVector(0., 0., 1.),
+                                        1. * MeV), 0., G4ThreeVector());
+  G4Track proton(new G4DynamicParticle(G4Proton::Definition(), G4ThreeVector(0., 0., 1.),
+                                       10. * MeV), 0., G4ThreeVector());
+  G4Step neutronStep, protonStep;
+  SetStep(neutronStep, neutron, detectors.back());
+  SetStep(protonStep, proton, detectors.back());
+
+  std::printf("%-42s %12s %14s %12s\n", "", "ns/call", "allocs/call", "calls");
+
+  const long stepsPerEvent = kTracksPerEvent * kStepsPerTrack;
+  for (auto mode : { B2::TrackerSD::HitMode::Step, B2::TrackerSD::HitMode::Track }) {
+    B2::TrackerSD::SetHitMode(mode);
+    const char* name = mode == B2::TrackerSD::HitMode::Track
+                       ? "TrackerSD::ProcessHits (track mode)"
+                       : "TrackerSD::ProcessHits (step mode)";
+    Measure(name, calls, stepsPerEvent, [&]() {
+      G4HCofThisEvent hce(capacity);
+      detectors.back().sd->Initialize(&hce);
+      ProcessHits(detectors.back(), neutronStep, neutron);
+    });
+  }
+  B2::TrackerSD::SetHitMode(B2::TrackerSD::HitMode::Step);
+
+  Measure("TrackerSD::ProcessHits (proton)", calls, stepsPerEvent, [&]() {
+    G4HCofThisEvent hce(capacity);
+    detectors.back().sd->Initialize(&hce);
+    ProcessHits(detectors.back(), protonStep, proton);
+  });
+
+  Measure("TrackerHit new/delete", calls, 1, []() {
+    auto hit = new B2::TrackerHit();
+    delete hit;
+  });
+
+  // One event with kHitsPerDetector neutron hits in each detector
+  B2::PrimaryGeneratorAction generator;
+  B2::EventAction eventAction;
+  G4Event event(0);
+  generator.GeneratePrimaries(&event);
+  auto hce = new G4HCofThisEvent(capacity);
+  event.SetHCofThisEvent(hce);
+  for (const auto& detector : detectors) {
+    detector.sd->Initialize(hce);
+    SetStep(neutronStep, neutron, detector);
+    for (G4int i = 0; i < kHitsPerDetector; ++i) {
+      neutron.SetTrackID(2 + i);
+      detector.sd->ProcessHits(&neutronStep, nullptr);
+    }
+  }
+  Measure("EventAction (begin and end of event)", calls / 100, 1, [&]() {
+    eventAction.BeginOfEventAction(&event);
+    eventAction.EndOfEventAction(&event);
+  });
+
+  G4int eventID = 0;
+  Measure("PrimaryGeneratorAction::GeneratePrimaries", calls, 1, [&]() {
+    G4Event primaries(eventID++);
+    generator.GeneratePrimaries(&primaries);
+  });
+
+  analysisManager->Write();
+  analysisManager->CloseFile();
+  return 0;
+}
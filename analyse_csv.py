@@ -98,6 +98,12 @@ def read_ntuples(file_names):
     f = np.sqrt(10**s) / (10**s - 1)
 
 
+def read_reduced(name):
+    summary = pd.read_csv(f'{name}_summary.csv')
+    spectra = pd.read_csv(f'{name}_spectra.csv')
+    return summary, spectra
+
+
 def main():
     #read_histo('Run0_h1_E.csv')
     #read_histo('Run0_h1_Edep.csv')
@@ -107,27 +113,22 @@ def main():
 
     #read_ntuples(glob.glob('Run0_nt_Ntuple_t*.csv'))
 
-    files = glob.glob('Run0_*mm_nt_Ntuple_t*.csv')
-    ds = [int(f.split('_')[1].replace('mm', '')) for f in files]
-    ds = np.flip(np.unique(ds))
-
-    N_primaries = 1e7
-    uA = N_primaries / 6.25e12
+    # Per-event sums and spectra come from the reduceNtuples tool, run e.g. as
+    # ./reduceNtuples --primaries 1e7 Run0_*mm
+    summary, spectra = read_reduced('reduced')
+    summary['d'] = summary.prefix.str.split('_').str[1].str.replace('mm', '').astype(int)
+    spectra['d'] = spectra.prefix.str.split('_').str[1].str.replace('mm', '').astype(int)
+    summary = summary[summary.detector == 4].sort_values('d', ascending=False)
+    ds = summary.d.values
 
     plt.figure(figsize=(16, 8))
-    Fs = []
     for i,d in enumerate(ds):
-        df = read_ntuples(glob.glob(f'Run0_{d}mm_nt_Ntuple_t*.csv'))
-        Es = df[df.Detector == 4].groupby('Evt').sum()
-
-        _, bin_edges = np.histogram(np.log10(Es.E), bins=100)
-        plt.hist(Es.E, bins=10**bin_edges, label=f'{d} mm' if d in (2, 80) else None, histtype='step', color=[0.9*i/len(ds)]*3, linewidth=2)
-
-        Fs.append(len(Es))
+        s = spectra[(spectra.d == d) & (spectra.detector == 4)]
+        plt.stairs(s.events.values, np.append(s.eLow.values, s.eHigh.values[-1]), label=f'{d} mm' if d in (2, 80) else None, color=[0.9*i/len(ds)]*3, linewidth=2)
     plt.semilogx()
 
     x = np.array(ds)
-    y = np.array(Fs) / uA
+    y = summary.countsPerUA.values
     plt.xlabel('Energy [keV]')
     plt.ylabel('Neutrons exiting the moderator')
     plt.legend(title='Moderator thickness')
@@ -0,0 +1,254 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file beamBench.cc
+/// \brief Variance of the beam spot sampling modes of B2::BeamProfile
+//
+// Usage: beamBench [samples] [replicas]
+//
+// For the disc and gauss profiles and every sampling mode, draws the given
+// number of beam positions in each of several replicas, which differ by
+// their master seed, and estimates two position-sensitive quantities: the
+// fraction of protons on a 10 x 10 mm patch off the axis and the mean
+// squared radius. The spread of the estimates over the replicas gives the
+// variance of each mode; its ratio to the pseudo-random variance is the
+// factor by which the number of events can shrink for the same error. The
+// means are checked against the pseudo-random ones and the exact mean
+// squared radius. For the map profile, a small weighted map is written to
+// beamBench.map and loaded, and the fraction of the samples in each of its
+// cells is checked against the weight of the cell. Returns 1 if a check
+// fails.
+
+#include "BeamProfile.hh"
+#include "EventSeeder.hh"
+
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+
+struct Estimate
+{
+  double patchMean = 0., patchVariance = 0.;
+  double r2Mean = 0., r2Variance = 0.;
+  double nsPerSample = 0.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Estimate Run(long nSamples, int nReplicas)
+{
+  auto beamProfile = B2::BeamProfile::Instance();
+  auto eventSeeder = B2::EventSeeder::Instance();
+
+  std::vector<double> patch, r2;
+  auto start = std::chrono::steady_clock::now();
+  for (int replica = 0; replica < nReplicas; ++replica) {
+    eventSeeder->SetMasterSeed(1000 + replica);
+    G4Random::setTheSeed(1000 + replica);
+
+    long inPatch = 0;
+    double sumR2 = 0.;
+    for (long i = 0; i < nSamples; ++i) {
+      G4TwoVector position = beamProfile->Sample(i);
+      double x = position.x() / mm, y = position.y() / mm;
+      if (x > 5. && x < 15. && std::fabs(y) < 5.) ++inPatch;
+      sumR2 += x * x + y * y;
+    }
+    patch.push_back(double(inPatch) / nSamples);
+    r2.push_back(sumR2 / nSamples);
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  auto moments = [](const std::vector<double>& values, double& mean, double& variance) {
+    mean = 0.;
+    for (double value : values) mean += value;
+    mean /= values.size();
+    variance = 0.;
+    for (double value : values) variance += (value - mean) * (value - mean);
+    variance /= values.size() - 1;
+  };
+  Estimate estimate;
+  moments(patch, estimate.patchMean, estimate.patchVariance);
+  moments(r2, estimate.r2Mean, estimate.r2Variance);
+  estimate.nsPerSample = elapsed.count() / (double(nSamples) * nReplicas) * 1.e9;
+  return estimate;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Means differing by less than five standard errors
+bool Consistent(double mean, double variance, double expected, double expectedVariance,
+                int nReplicas)
+{
+  double sigma = std::sqrt((variance + expectedVariance) / nReplicas);
+  return std::fabs(mean - expected) <= 5. * sigma + 1.e-12 * std::fabs(expected);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Cell counts of the map profile against the cell weights: largest
+// deviation in standard deviations of the binomial count, or -1 if a
+// sample falls outside the map or into a cell of weight zero
+double MapPull(long nSamples, const std::vector<double>& weights, int nx,
+               double xMin, double xMax, double yMin, double yMax)
+{
+  auto beamProfile = B2::BeamProfile::Instance();
+  B2::EventSeeder::Instance()->SetMasterSeed(1000);
+  G4Random::setTheSeed(1000);
+
+  int ny = int(weights.size()) / nx;
+  double dx = (xMax - xMin) / nx, dy = (yMax - yMin) / ny;
+  std::vector<long> counts(weights.size(), 0);
+  for (long i = 0; i < nSamples; ++i) {
+    G4TwoVector position = beamProfile->Sample(i);
+    double x = position.x() / mm, y = position.y() / mm;
+    if (x < xMin || x >= xMax || y < yMin || y >= yMax) return -1.;
+    int ix = std::min(int((x - xMin) / dx), nx - 1);
+    int iy = std::min(int((y - yMin) / dy), ny - 1);
+    ++counts[iy * nx + ix];
+  }
+
+  double total = 0.;
+  for (double weight : weights) total += weight;
+  double maxPull = 0.;
+  for (std::size_t cell = 0; cell < weights.size(); ++cell) {
+    double p = weights[cell] / total;
+    if (p == 0.) {
+      if (counts[cell] > 0) return -1.;
+      continue;
+    }
+    double pull = std::fabs(counts[cell] - nSamples * p) / std::sqrt(nSamples * p * (1. - p));
+    maxPull = std::max(maxPull, pull);
+  }
+  return maxPull;
+}
+
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  long nSamples = argc > 1 ? std::atol(argv[1]) : 10000;
+  int nReplicas = argc > 2 ? std::atoi(argv[2]) : 100;
+  if (nSamples <= 0 || nReplicas < 2) {
+    std::fprintf(stderr, "Usage: %s [samples] [replicas>1]\n", argv[0]);
+    return 1;
+  }
+
+  const double radius = 19., sigma = 5.;
+  auto beamProfile = B2::BeamProfile::Instance();
+  beamProfile->SetRadius(radius * mm);
+  beamProfile->SetSigma(sigma * mm);
+  beamProfile->SetStrata(int(std::sqrt(double(nSamples))));
+
+  struct Profile { const char* name; B2::BeamProfile::Shape shape; double r2; };
+  struct Sampling { const char* name; B2::BeamProfile::Sampling sampling; };
+  const Profile profiles[] = {
+    { "disc", B2::BeamProfile::Shape::Disc, radius * radius / 2. },
+    { "gauss", B2::BeamProfile::Shape::Gauss, 2. * sigma * sigma } };
+  const Sampling samplings[] = {
+    { "pseudo", B2::BeamProfile::Sampling::Pseudo },
+    { "stratified", B2::BeamProfile::Sampling::Stratified },
+    { "sobol", B2::BeamProfile::Sampling::Sobol } };
+
+  std::printf("%ld samples, %d replicas, %d x %d strata\n\n", nSamples, nReplicas,
+              int(std::sqrt(double(nSamples))), int(std::sqrt(double(nSamples))));
+  std::printf("%-8s %-12s %12s %12s %10s %12s %12s %10s %10s %6s\n", "profile", "sampling",
+              "patch", "rms", "gain", "<r2> [mm2]", "rms", "gain", "ns/sample", "check");
+
+  bool ok = true;
+  for (const auto& profile : profiles) {
+    beamProfile->SetShape(profile.shape);
+    Estimate pseudo;
+    for (const auto& sampling : samplings) {
+      beamProfile->SetSampling(sampling.sampling);
+      Estimate estimate = Run(nSamples, nReplicas);
+      if (sampling.sampling == B2::BeamProfile::Sampling::Pseudo) pseudo = estimate;
+
+      bool checked =
+        Consistent(estimate.patchMean, estimate.patchVariance, pseudo.patchMean,
+                   pseudo.patchVariance, nReplicas)
+        && Consistent(estimate.r2Mean, estimate.r2Variance, profile.r2, 0., nReplicas);
+      ok &= checked;
+
+      // Variance reduction relative to pseudo-random sampling
+      double patchGain = estimate.patchVariance > 0.
+                       ? pseudo.patchVariance / estimate.patchVariance : INFINITY;
+      double r2Gain = estimate.r2Variance > 0. ? pseudo.r2Variance / estimate.r2Variance : INFINITY;
+      std::printf("%-8s %-12s %12.6f %12.3g %10.1f %12.4f %12.3g %10.1f %10.1f %6s\n",
+                  profile.name, sampling.name, estimate.patchMean,
+                  std::sqrt(estimate.patchVariance), patchGain, estimate.r2Mean,
+                  std::sqrt(estimate.r2Variance), r2Gain, estimate.nsPerSample,
+                  checked ? "ok" : "FAILED");
+    }
+  }
+
+  // Map profile: 3 x 2 cells, one of them empty
+  const std::vector<double> weights = { 1., 2., 3.,
+                                        4., 0., 6. };
+  const int nx = 3;
+  const double xMin = -15., xMax = 15., yMin = -5., yMax = 5.;
+  const char* mapFile = "beamBench.map";
+  {
+    std::ofstream out(mapFile);
+    out << "# beamBench check map\n" << xMin << " " << xMax << " " << yMin << " " << yMax << "\n";
+    for (std::size_t cell = 0; cell < weights.size(); ++cell) {
+      out << weights[cell] << ((cell + 1) % nx == 0 ? "\n" : " ");
+    }
+  }
+  bool loaded = beamProfile->LoadMap(mapFile);
+  std::remove(mapFile);
+  if ( ! loaded ) {
+    std::printf("map: cannot load %s\n", mapFile);
+    ok = false;
+  }
+  else {
+    beamProfile->SetShape(B2::BeamProfile::Shape::Map);
+    std::printf("\n%-8s %-12s %12s %6s\n", "profile", "sampling", "max pull", "check");
+    for (const auto& sampling : samplings) {
+      beamProfile->SetSampling(sampling.sampling);
+      double pull = MapPull(nSamples * nReplicas, weights, nx, xMin, xMax, yMin, yMax);
+      bool checked = pull >= 0. && pull < 5.;
+      ok &= checked;
+      std::printf("%-8s %-12s %12.2f %6s\n", "map", sampling.name, pull,
+                  checked ? "ok" : "FAILED");
+    }
+  }
+
+  std::printf("\n%s\n", ok ? "All checks passed" : "Some checks FAILED");
+  return ok ? 0 : 1;
+}
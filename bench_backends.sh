@@ -0,0 +1,36 @@
+#!/bin/bash
+
+# Compares the wall-clock time of the MT, tasking and serial run managers
+# for several event grains (/run/eventModulo) on the standard geometry, and
+# extrapolates it to a production run of TARGET events. The tail column is
+# the time between the first and the last worker running out of events.
+
+set -e
+
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+export NEVENTS="${NEVENTS:-1000000}"
+export PINNING="${PINNING:-none}"
+BACKENDS="${BACKENDS:-mt tasking serial}"
+MODULOS="${MODULOS:-0 1 10 100 1000}"
+TARGET="${TARGET:-100000000}"
+
+printf "%-8s %8s %12s %10s %8s %10s %14s\n" \
+    backend modulo events/s wall[s] idle tail[s] "${TARGET}ev[h]"
+for backend in $BACKENDS
+do
+    for modulo in $MODULOS
+    do
+        export RUN_ID="bench_${backend}_m${modulo}"
+        log="output_${RUN_ID}.log"
+        ./exampleB2b --run-manager "$backend" --event-modulo "$modulo" bench.mac > "$log"
+        rate=$(grep '^Throughput:' "$log" | awk '{print $2}')
+        wall=$(grep '^Wall time:' "$log" | awk '{print $3}')
+        idle=$(grep '^Wall time:' "$log" | awk '{print $6}')
+        tail=$(grep '^Wall time:' "$log" | awk '{print $10}')
+        hours=$(awk -v r="$rate" -v n="$TARGET" 'BEGIN { if (r > 0) printf "%.2f", n / r / 3600 }')
+        printf "%-8s %8s %12s %10s %7s%% %10s %14s\n" \
+            "$backend" "$modulo" "$rate" "$wall" "$idle" "$tail" "$hours"
+        # The serial run manager has no event grain
+        [ "$backend" = serial ] && break
+    done
+done
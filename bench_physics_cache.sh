@@ -0,0 +1,41 @@
+#!/bin/bash
+
+# Startup time without the physics table cache, with an empty cache (the
+# tables are built and stored) and with the cache filled by the previous
+# run (the tables are retrieved). Prints the means over REPEAT runs of the
+# wall time, the /run/initialize total and the physics table phase as
+# reported by B2::StartupProfiler.
+
+set -e
+
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+export NTHREADS="${NTHREADS:-1}"
+REPEAT="${REPEAT:-5}"
+CACHE="${CACHE:-bench_physics_tables}"
+EXE="${EXE:-./exampleB2bBatch}"
+
+printf "%-8s %10s %12s %12s\n" cache wall[s] initialize[s] tables[s]
+rm -rf "$CACHE"
+for mode in none cold warm
+do
+    case "$mode" in
+        none) export TABLE_CACHE=none ;;
+        *)    export TABLE_CACHE="$CACHE" ;;
+    esac
+    export RUN_ID="physics_cache_${mode}"
+    log="output_${RUN_ID}.log"
+    wall=0
+    init=0
+    tables=0
+    for ((i=0; i<REPEAT; i++))
+    do
+        if [ "$mode" = cold ]; then rm -rf "$CACHE"; fi
+        /usr/bin/time -f "%e" -o time.txt "$EXE" physics_cache.mac > "$log"
+        wall=$(awk -v a="$wall" '{ print a + $1 }' time.txt)
+        init=$(awk -v a="$init" '/^total/ && ! done { a += $2; done = 1 } END { print a }' "$log")
+        tables=$(awk -v a="$tables" '/^physics tables/ { a += $3 } END { print a }' "$log")
+    done
+    awk -v m="$mode" -v w="$wall" -v i="$init" -v t="$tables" -v n="$REPEAT" \
+        'BEGIN { printf "%-8s %10.3f %12.3f %12.3f\n", m, w / n, i / n, t / n }'
+done
+rm -f time.txt
@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# Compares the throughput of unpinned, compactly pinned and NUMA-spread
+# worker threads on the standard geometry. Each mode runs REPEATS times
+# with NEVENTS events and one thread per available core.
+
+set -e
+
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+export NEVENTS="${NEVENTS:-200000}"
+REPEATS="${REPEATS:-3}"
+
+for mode in none compact numa
+do
+    export PINNING="$mode"
+    for ((r=1; r<=REPEATS; r++))
+    do
+        export RUN_ID="bench_${mode}_${r}"
+        ./exampleB2b bench.mac > "output_${RUN_ID}.log"
+        rate=$(grep '^Throughput:' "output_${RUN_ID}.log" | awk '{print $2}')
+        echo "${mode} ${r} ${rate} events/s"
+    done
+done | awk '{ print; sum[$1] += $3; n[$1]++ }
+            END { for (m in sum) printf "mean %-8s %12.1f events/s\n", m, sum[m] / n[m] }'
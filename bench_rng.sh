@@ -0,0 +1,30 @@
+#!/bin/bash
+
+# Compares the default MixMax engine with the batched xoshiro engine: raw
+# throughput and quality checks of the engines (rngBench), then the
+# events/s of whole runs on the standard geometry for each run manager.
+
+set -e
+
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+export NEVENTS="${NEVENTS:-1000000}"
+export PINNING="${PINNING:-none}"
+BACKENDS="${BACKENDS:-mt serial}"
+ENGINES="${ENGINES:-mixmax xoshiro}"
+
+./rngBench "${NUMBERS:-100000000}"
+echo
+
+printf "%-8s %-8s %12s %10s\n" backend engine events/s wall[s]
+for backend in $BACKENDS
+do
+    for engine in $ENGINES
+    do
+        export RUN_ID="bench_${backend}_${engine}"
+        log="output_${RUN_ID}.log"
+        ./exampleB2b --run-manager "$backend" --rng "$engine" bench.mac > "$log"
+        rate=$(grep '^Throughput:' "$log" | awk '{print $2}')
+        wall=$(grep '^Wall time:' "$log" | awk '{print $3}')
+        printf "%-8s %-8s %12s %10s\n" "$backend" "$engine" "$rate" "$wall"
+    done
+done
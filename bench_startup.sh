@@ -0,0 +1,31 @@
+#!/bin/bash
+
+# Compares the startup of the batch-only executable with the full one on
+# startup.mac (initialisation and one event): the wall time averaged over
+# REPEAT runs and the largest peak RSS (GNU time), and the number of
+# shared libraries each one loads.
+
+set -e
+
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+export NTHREADS="${NTHREADS:-1}"
+REPEAT="${REPEAT:-5}"
+
+printf "%-16s %10s %12s %10s\n" executable wall[s] maxRSS[MB] libraries
+for exe in exampleB2b exampleB2bBatch
+do
+    export RUN_ID="startup_${exe}"
+    total=0
+    rss=0
+    for ((i=0; i<REPEAT; i++))
+    do
+        /usr/bin/time -f "%e %M" -o time.txt ./"$exe" startup.mac > "output_${RUN_ID}.log"
+        read -r wall kb < time.txt
+        total=$(awk -v a="$total" -v b="$wall" 'BEGIN { print a + b }')
+        rss=$(( kb > rss ? kb : rss ))
+    done
+    libraries=$(ldd "./$exe" | wc -l)
+    awk -v e="$exe" -v t="$total" -v n="$REPEAT" -v r="$rss" -v l="$libraries" \
+        'BEGIN { printf "%-16s %10.3f %12.1f %10d\n", e, t / n, r / 1024., l }'
+done
+rm -f time.txt
@@ -0,0 +1,66 @@
+#!/bin/bash
+
+# Runs the moderator thicknesses of THICKNESSES with NEVENTS events each,
+# one serial process per point:
+#   sequential   one process after the other, as run.sh does
+#   independent  all processes at the same time
+#   fork         sweep.mac, the points forked from one initialised process
+# and prints the wall time, the aggregate throughput and the peak memory
+# of all processes together, as the sum of their proportional set sizes
+# (shared pages are divided between the processes sharing them).
+
+set -e
+
+THICKNESSES="${THICKNESSES:-0 20 40 80}"
+export NEVENTS="${NEVENTS:-2000}"
+export PINNING=none
+EXE="${EXE:-./exampleB2bBatch}"
+points=($THICKNESSES)
+
+# Peak summed PSS [MB] of the running executables while process $1 lives
+peak_pss() {
+    local peak=0 total kb
+    while kill -0 "$1" 2>/dev/null
+    do
+        total=0
+        for pid in $(pgrep -x "$(basename "$EXE")")
+        do
+            kb=$(awk '/^Pss:/ { print $2 }' "/proc/$pid/smaps_rollup" 2>/dev/null)
+            total=$((total + ${kb:-0}))
+        done
+        peak=$((total > peak ? total : peak))
+        sleep 0.2
+    done
+    echo $((peak / 1024))
+}
+
+run_point() {
+    RUN_ID="bench_sweep_${1}mm" MODERATOR_THICKNESS="$1" \
+        "$EXE" --run-manager serial bench.mac > "output_bench_sweep_${1}mm.log"
+}
+
+run_mode() {
+    case "$1" in
+        sequential)
+            for t in "${points[@]}"; do run_point "$t"; done ;;
+        independent)
+            for t in "${points[@]}"; do run_point "$t" & done
+            wait ;;
+        fork)
+            RUN_ID=bench_sweep SWEEP_THICKNESSES="$THICKNESSES" SWEEP_PROCESSES=${#points[@]} \
+                "$EXE" --run-manager serial sweep.mac > output_bench_sweep.log ;;
+    esac
+}
+
+printf "%-12s %10s %12s %14s\n" mode wall[s] events/s peakPSS[MB]
+for mode in sequential independent fork
+do
+    start=$(date +%s.%N)
+    run_mode "$mode" &
+    runner=$!
+    peak=$(peak_pss "$runner")
+    wait "$runner"
+    end=$(date +%s.%N)
+    awk -v m="$mode" -v s="$start" -v e="$end" -v n="$NEVENTS" -v p="${#points[@]}" -v r="$peak" \
+        'BEGIN { printf "%-12s %10.2f %12.1f %14d\n", m, e - s, n * p / (e - s), r }'
+done
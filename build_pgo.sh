@@ -0,0 +1,56 @@
+#!/bin/bash
+
+# Profile-guided and link-time optimised build of exampleB2b. Builds a plain
+# release and an instrumented executable, trains the instrumented one on
+# pgo.mac (20 mm moderator, 1e5 events), rebuilds with the profile and LTO
+# and reports the events/s of the release and the optimised build on the
+# same macro. Run it from the source directory (or set SOURCE_DIR); the
+# builds go to BUILD_DIR, the optimised executable is BUILD_DIR/use/exampleB2b.
+
+set -e
+
+SOURCE_DIR="$(cd "${SOURCE_DIR:-$(dirname "$0")}" && pwd)"
+mkdir -p "${BUILD_DIR:-build_pgo}"
+BUILD_DIR="$(cd "${BUILD_DIR:-build_pgo}" && pwd)"
+PROFILE_DIR="$BUILD_DIR/profile"
+JOBS="${JOBS:-$(nproc)}"
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+export NEVENTS="${NEVENTS:-100000}"
+
+build() {
+    local name="$1"
+    shift
+    echo "Building $name"
+    cmake -S "$SOURCE_DIR" -B "$BUILD_DIR/$name" -DCMAKE_BUILD_TYPE=Release \
+          -DB2B_PGO_DIR="$PROFILE_DIR" "$@" > "$BUILD_DIR/${name}_build.log"
+    cmake --build "$BUILD_DIR/$name" --target exampleB2b -j"$JOBS" >> "$BUILD_DIR/${name}_build.log"
+}
+
+# Events/s of the executable of a build on pgo.mac
+rate() {
+    local log="output_pgo_$1.log"
+    cd "$BUILD_DIR/$1"
+    RUN_ID="pgo_$1" ./exampleB2b pgo.mac > "$log"
+    grep '^Throughput:' "$log" | awk '{print $2}'
+    cd - > /dev/null
+}
+
+rm -rf "$PROFILE_DIR"
+build release -DB2B_PGO=OFF -DB2B_LTO=OFF
+build generate -DB2B_PGO=GENERATE -DB2B_LTO=OFF
+
+echo "Training on pgo.mac with $NEVENTS events"
+rate generate > /dev/null
+# Clang writes raw profiles that have to be merged
+if ls "$PROFILE_DIR"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -output="$PROFILE_DIR/default.profdata" "$PROFILE_DIR"/*.profraw
+fi
+
+build use -DB2B_PGO=USE -DB2B_LTO=ON
+
+echo "Measuring on pgo.mac with $NEVENTS events"
+release=$(rate release)
+optimised=$(rate use)
+printf "%-10s %12s\n" build events/s release "$release" pgo+lto "$optimised"
+awk -v a="$release" -v b="$optimised" \
+    'BEGIN { if (a > 0) printf "Gain of pgo+lto: %+.1f%%\n", 100. * (b / a - 1.) }'
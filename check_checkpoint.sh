@@ -0,0 +1,76 @@
+#!/bin/bash
+
+# Runs checkpoint.mac once without interruption and once killed after its
+# checkpoints and resumed, then reduces both ntuples with reduceNtuples.
+# In each run the histories with a hit in a detector, counted from the
+# ntuple, must equal its tally, so no event of the killed segment is
+# counted twice; the counts of the two runs must agree within five
+# standard deviations. Registered with CTest as the checkpoint test; EXE
+# and REDUCE select the executables.
+
+set -e
+
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+export NTHREADS="${NTHREADS:-4}"
+export NEVENTS="${NEVENTS:-200000}"
+EXE="${EXE:-./exampleB2b}"
+REDUCE="${REDUCE:-./reduceNtuples}"
+
+# Uninterrupted reference
+RUN_ID=checkpoint_full INTERVAL=0 "$EXE" checkpoint.mac > output_checkpoint_full.log
+
+# Killed one and a half intervals after its first checkpoint, then resumed
+export RUN_ID=checkpoint_resumed
+export INTERVAL="${INTERVAL:-2}"
+rm -rf "checkpoint_${RUN_ID}" Run0_${RUN_ID}_*
+"$EXE" checkpoint.mac > "output_${RUN_ID}_killed.log" &
+pid=$!
+while kill -0 "$pid" 2> /dev/null && ! ls "checkpoint_${RUN_ID}"/segment0_*.ckpt > /dev/null 2>&1
+do
+    sleep 0.2
+done
+sleep "$(awk -v interval="$INTERVAL" 'BEGIN { print 1.5 * interval }')"
+if ! kill -9 "$pid" 2> /dev/null; then
+    echo "The run finished before it could be killed: raise NEVENTS"
+    exit 1
+fi
+wait "$pid" || true
+"$EXE" checkpoint.mac > "output_${RUN_ID}.log"
+
+"$REDUCE" -o reduced_checkpoint --primaries "$NEVENTS" Run0_checkpoint_full Run0_checkpoint_resumed
+
+# Detector numbers of DetectorConstruction, and the tallies of both runs
+awk -F, '
+    BEGIN { number["Moderator"] = 1; number["BertholdGas"] = 3; number["Scorer1"] = 4 }
+    FILENAME ~ /_tallies.csv$/ {
+        if ($0 ~ /^#/ || $1 == "name") next
+        run = FILENAME ~ /resumed/ ? "Run0_checkpoint_resumed" : "Run0_checkpoint_full"
+        tally[run, number[$1]] = $3
+        names[number[$1]] = $1
+        next
+    }
+    $1 != "prefix" { events[$1, $2] = $3 }
+    END {
+        status = 0
+        for (id in names) {
+            for (r = 0; r < 2; ++r) {
+                run = r ? "Run0_checkpoint_resumed" : "Run0_checkpoint_full"
+                if (events[run, id] + 0 != tally[run, id] + 0) {
+                    printf "MISMATCH: %s %s: %d histories in the ntuple, %d in the tally\n",
+                           run, names[id], events[run, id], tally[run, id]
+                    status = 1
+                }
+            }
+            full = events["Run0_checkpoint_full", id]
+            resumed = events["Run0_checkpoint_resumed", id]
+            sigma = sqrt(full + resumed)
+            pull = sigma > 0 ? (resumed - full) / sigma : 0
+            printf "%-12s uninterrupted %d resumed %d (%.1f sigma)\n", names[id], full, resumed, pull
+            if (resumed - full > 5 * sigma || full - resumed > 5 * sigma) {
+                print "MISMATCH: " names[id] " differs by more than 5 sigma"
+                status = 1
+            }
+        }
+        exit status
+    }' Run0_checkpoint_full_tallies.csv Run0_checkpoint_resumed_seg1_tallies.csv \
+       reduced_checkpoint_summary.csv && echo "Resumed run consistent with the uninterrupted one"
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Runs seeding.mac with 1, 4 and 22 threads and checks that the histogram
+# entries, i.e. the tallies, do not depend on the number of threads.
+# Registered with CTest as the seeding test; EXE selects the executable.
+
+set -e
+
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+EXE="${EXE:-./exampleB2b}"
+
+for n in 1 4 22
+do
+    export NTHREADS="$n"
+    export RUN_ID="seeding_t${n}"
+    "$EXE" seeding.mac > "output_${RUN_ID}.log"
+done
+
+status=0
+for f in Run0_seeding_t1_h1_*.csv
+do
+    for n in 4 22
+    do
+        g="${f/_t1_/_t${n}_}"
+        if ! cmp -s <(grep -v '^#' "$f" | cut -d, -f1) <(grep -v '^#' "$g" | cut -d, -f1); then
+            echo "MISMATCH: $f vs $g"
+            status=1
+        fi
+    done
+done
+
+[ $status -eq 0 ] && echo "Tallies identical for 1, 4 and 22 threads"
+exit $status
@@ -0,0 +1,308 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file compareRuns.cc
+/// \brief Statistical comparison of an exampleB2b run with a reference run
+//
+// Usage: compareRuns [--alpha p] <reference-prefix> <run-prefix> [histogram...]
+//
+// A prefix is the file base of one run, e.g. Run0_regression_20mm. For
+// each histogram (default ES1 and E, the Scorer1 and Berthold spectra) the
+// shapes of <prefix>_h1_<histogram>.csv are compared with a two-sample
+// chi2 test over the bins filled in either run and with a Kolmogorov-
+// Smirnov test of the binned cumulative distributions. The rates, i.e.
+// the means of every tally of <prefix>_tallies.csv, are compared with a
+// two-sided z test from their relative errors, so runs of different
+// lengths can be compared. A test fails if its p-value is below alpha
+// (default 0.001). The events/s of <prefix>_stats.json are printed for
+// both runs as the speed-up of the run over the reference.
+// Returns 1 if a test fails or an input is missing.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct Tally
+{
+  double histories = 0.;
+  double mean = 0.;
+  double relError = 0.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Entries of the bins 1..n of a tools::histo CSV file, without under- and
+// overflow
+bool ReadHistogram(const std::string& file, std::vector<double>& entries)
+{
+  std::ifstream in(file);
+  if ( ! in ) {
+    std::fprintf(stderr, "Cannot read %s\n", file.c_str());
+    return false;
+  }
+  std::string line;
+  bool columns = false;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    // The first line holds the column names
+    if ( ! columns ) {
+      columns = true;
+      continue;
+    }
+    entries.push_back(std::strtod(line.c_str(), nullptr));
+  }
+  if (entries.size() < 3) {
+    std::fprintf(stderr, "No bins in %s\n", file.c_str());
+    return false;
+  }
+  entries.erase(entries.begin());
+  entries.pop_back();
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ReadTallies(const std::string& file, std::map<std::string, Tally>& tallies)
+{
+  std::ifstream in(file);
+  if ( ! in ) {
+    std::fprintf(stderr, "Cannot read %s\n", file.c_str());
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#' || line.compare(0, 5, "name,") == 0) continue;
+    std::stringstream stream(line);
+    std::string name, histories, sum, sum2, mean, relError;
+    std::getline(stream, name, ',');
+    std::getline(stream, histories, ',');
+    std::getline(stream, sum, ',');
+    std::getline(stream, sum2, ',');
+    std::getline(stream, mean, ',');
+    std::getline(stream, relError, ',');
+    tallies[name] = { std::atof(histories.c_str()), std::atof(mean.c_str()),
+                      std::atof(relError.c_str()) };
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Value of "eventsPerSecond" in a stats file, 0 if there is none
+double ReadEventsPerSecond(const std::string& file)
+{
+  std::ifstream in(file);
+  std::string line;
+  const std::string key = "\"eventsPerSecond\":";
+  while (std::getline(in, line)) {
+    std::size_t position = line.find(key);
+    if (position != std::string::npos) {
+      return std::strtod(line.c_str() + position + key.size(), nullptr);
+    }
+  }
+  return 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Upper regularised incomplete gamma function Q(a, x)
+double GammaQ(double a, double x)
+{
+  if (x <= 0.) return 1.;
+  double logPrefactor = a * std::log(x) - x - std::lgamma(a);
+  if (x < a + 1.) {
+    // Series of P(a, x)
+    double term = 1. / a, sum = term;
+    for (int n = 1; n < 1000 && std::fabs(term) > std::fabs(sum) * 1.e-15; ++n) {
+      term *= x / (a + n);
+      sum += term;
+    }
+    return std::max(0., 1. - sum * std::exp(logPrefactor));
+  }
+  // Continued fraction of Q(a, x), modified Lentz method
+  const double tiny = 1.e-300;
+  double b = x + 1. - a, c = 1. / tiny, d = 1. / b, h = d;
+  for (int n = 1; n < 1000; ++n) {
+    double an = -n * (n - a);
+    b += 2.;
+    d = an * d + b;
+    if (std::fabs(d) < tiny) d = tiny;
+    c = b + an / c;
+    if (std::fabs(c) < tiny) c = tiny;
+    d = 1. / d;
+    double delta = d * c;
+    h *= delta;
+    if (std::fabs(delta - 1.) < 1.e-15) break;
+  }
+  return std::exp(logPrefactor) * h;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Probability of a Kolmogorov distance larger than lambda
+double KolmogorovQ(double lambda)
+{
+  if (lambda < 0.2) return 1.;
+  double sum = 0.;
+  for (int j = 1; j <= 100; ++j) {
+    double term = 2. * (j % 2 ? 1. : -1.) * std::exp(-2. * j * j * lambda * lambda);
+    sum += term;
+    if (std::fabs(term) < 1.e-12) break;
+  }
+  return std::min(1., std::max(0., sum));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool CompareHistogram(const std::string& name, const std::string& referenceFile,
+                      const std::string& runFile, double alpha)
+{
+  std::vector<double> reference, run;
+  if ( ! ReadHistogram(referenceFile, reference) || ! ReadHistogram(runFile, run) ) {
+    return false;
+  }
+  if (reference.size() != run.size()) {
+    std::printf("%-12s FAILED: %zu bins in the reference, %zu in the run\n",
+                name.c_str(), reference.size(), run.size());
+    return false;
+  }
+
+  double n1 = 0., n2 = 0.;
+  for (std::size_t i = 0; i < run.size(); ++i) {
+    n1 += reference[i];
+    n2 += run[i];
+  }
+  if (n1 <= 0. || n2 <= 0.) {
+    bool ok = n1 == n2;
+    std::printf("%-12s entries %g / %g  %s\n", name.c_str(), n1, n2,
+                ok ? "ok" : "FAILED: empty in one run");
+    return ok;
+  }
+
+  // Two-sample chi2 of the shapes, one degree of freedom less than the
+  // bins filled in either run
+  double chi2 = 0., cumulative1 = 0., cumulative2 = 0., distance = 0.;
+  int ndf = -1;
+  for (std::size_t i = 0; i < run.size(); ++i) {
+    double sum = reference[i] + run[i];
+    if (sum > 0.) {
+      double difference = n2 * reference[i] - n1 * run[i];
+      chi2 += difference * difference / (n1 * n2 * sum);
+      ++ndf;
+    }
+    cumulative1 += reference[i] / n1;
+    cumulative2 += run[i] / n2;
+    distance = std::max(distance, std::fabs(cumulative1 - cumulative2));
+  }
+  double chi2Probability = ndf > 0 ? GammaQ(0.5 * ndf, 0.5 * chi2) : 1.;
+
+  double effective = std::sqrt(n1 * n2 / (n1 + n2));
+  double ksProbability = KolmogorovQ((effective + 0.12 + 0.11 / effective) * distance);
+
+  bool ok = chi2Probability >= alpha && ksProbability >= alpha;
+  std::printf("%-12s entries %g / %g  chi2/ndf %.1f/%d p %.3g  KS D %.3g p %.3g  %s\n",
+              name.c_str(), n1, n2, chi2, ndf, chi2Probability, distance, ksProbability,
+              ok ? "ok" : "FAILED");
+  return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool CompareTallies(const std::string& referenceFile, const std::string& runFile,
+                    double alpha)
+{
+  std::map<std::string, Tally> reference, run;
+  if ( ! ReadTallies(referenceFile, reference) || ! ReadTallies(runFile, run) ) return false;
+
+  bool ok = true;
+  for (const auto& [name, expected] : reference) {
+    auto found = run.find(name);
+    if (found == run.end()) {
+      std::printf("%-12s FAILED: tally missing from the run\n", name.c_str());
+      ok = false;
+      continue;
+    }
+    const Tally& tally = found->second;
+    double sigma = std::hypot(expected.mean * std::max(0., expected.relError),
+                              tally.mean * std::max(0., tally.relError));
+    double z = sigma > 0. ? (tally.mean - expected.mean) / sigma : 0.;
+    bool same = sigma > 0. || tally.mean == expected.mean;
+    double probability = same ? std::erfc(std::fabs(z) / std::sqrt(2.)) : 0.;
+    bool passed = probability >= alpha;
+    std::printf("%-12s mean %.6g / %.6g  z %.2f p %.3g  %s\n", name.c_str(), expected.mean,
+                tally.mean, z, probability, passed ? "ok" : "FAILED");
+    ok &= passed;
+  }
+  return ok;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  double alpha = 1.e-3;
+  std::vector<std::string> arguments;
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--alpha" && i + 1 < argc) alpha = std::atof(argv[++i]);
+    else arguments.push_back(arg);
+  }
+  if (arguments.size() < 2 || alpha <= 0. || alpha >= 1.) {
+    std::fprintf(stderr, "Usage: %s [--alpha p] <reference-prefix> <run-prefix>"
+                         " [histogram...]\n", argv[0]);
+    return 1;
+  }
+  const std::string& reference = arguments[0];
+  const std::string& run = arguments[1];
+  std::vector<std::string> histograms(arguments.begin() + 2, arguments.end());
+  if (histograms.empty()) histograms = { "ES1", "E" };
+
+  std::printf("%s against reference %s, alpha %g\n", run.c_str(), reference.c_str(), alpha);
+  bool ok = true;
+  for (const auto& name : histograms) {
+    ok &= CompareHistogram(name, reference + "_h1_" + name + ".csv",
+                           run + "_h1_" + name + ".csv", alpha);
+  }
+  ok &= CompareTallies(reference + "_tallies.csv", run + "_tallies.csv", alpha);
+
+  double referenceRate = ReadEventsPerSecond(reference + "_stats.json");
+  double rate = ReadEventsPerSecond(run + "_stats.json");
+  std::printf("%-12s %.1f / %.1f events/s", "speed", referenceRate, rate);
+  if (referenceRate > 0. && rate > 0.) std::printf("  x%.3f", rate / referenceRate);
+  std::printf("\n%s\n", ok ? "Physics unchanged" : "Physics CHANGED");
+  return ok ? 0 : 1;
+}
@@ -29,9 +29,16 @@
 
 #include "DetectorConstruction.hh"
 #include "ActionInitialization.hh"
+#include "EventSeeder.hh"
+#include "PhysicsTableCache.hh"
+#include "StartupProfiler.hh"
+#include "ThreadPlacement.hh"
+#include "WorkerInitialization.hh"
+#include "XoshiroEngine.hh"
 #include "G4ScoringManager.hh"
 
 #include "G4RunManagerFactory.hh"
+#include "G4MTRunManager.hh"
 #include "G4SteppingVerbose.hh"
 #include "G4UImanager.hh"
 #include "FTFP_BERT.hh"
@@ -40,17 +47,84 @@
 
 #include "Randomize.hh"
 
+#include <cstdio>
+#include <cstdlib>
+
+// exampleB2bBatch is built without the UI and vis drivers
+#ifndef B2B_BATCH_ONLY
 #include "G4VisExecutive.hh"
 #include "G4UIExecutive.hh"
+#endif
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 int main(int argc,char** argv)
 {
-  // Detect interactive mode (if no arguments) and define UI session
+  // Parse the command line:
+  // exampleB2b [--shard i/n] [--run-manager mt|tasking|serial]
+  //            [--event-modulo n] [--rng mixmax|xoshiro] [macro]
+  //
+  G4String macro;
+  G4RunManagerType runManagerType = G4RunManagerType::Default;
+  G4int eventModulo = -1;
+  G4bool xoshiroEngine = false;
+  for ( G4int i = 1; i < argc; ++i ) {
+    G4String arg = argv[i];
+    if ( arg == "--run-manager" && i + 1 < argc ) {
+      G4String type = argv[++i];
+      if ( type == "mt" ) { runManagerType = G4RunManagerType::MT; }
+      else if ( type == "tasking" ) { runManagerType = G4RunManagerType::Tasking; }
+      else if ( type == "serial" ) { runManagerType = G4RunManagerType::Serial; }
+      else {
+        G4cerr << "Invalid run manager " << type << ", expected mt, tasking or serial"
+               << G4endl;
+        return 1;
+      }
+    }
+    else if ( arg == "--event-modulo" && i + 1 < argc ) {
+      eventModulo = std::atoi(argv[++i]);
+    }
+    else if ( arg == "--rng" && i + 1 < argc ) {
+      G4String engine = argv[++i];
+      if ( engine != "mixmax" && engine != "xoshiro" ) {
+        G4cerr << "Invalid random engine " << engine << ", expected mixmax or xoshiro"
+               << G4endl;
+        return 1;
+      }
+      xoshiroEngine = ( engine == "xoshiro" );
+    }
+    else if ( arg == "--shard" && i + 1 < argc ) {
+      G4int index = 0, nShards = 0;
+      if ( std::sscanf(argv[++i], "%d/%d", &index, &nShards) != 2 ) {
+        G4cerr << "Invalid shard " << argv[i] << ", expected i/n" << G4endl;
+        return 1;
+      }
+      B2::EventSeeder::Instance()->SetShard(index, nShards);
+    }
+    else if ( arg.compare(0, 2, "--") == 0 || ! macro.empty() ) {
+      // An unknown option, an option without its value or a second macro
+      G4cerr << "Invalid argument " << arg << G4endl
+             << "Usage: " << argv[0] << " [--shard i/n] [--run-manager mt|tasking|serial]"
+             << " [--event-modulo n] [--rng mixmax|xoshiro] [macro]" << G4endl;
+      return 1;
+    }
+    else {
+      macro = arg;
+    }
+  }
+
+#ifdef B2B_BATCH_ONLY
+  if ( macro.empty() ) {
+    G4cerr << "exampleB2bBatch runs a macro only, use exampleB2b for interactive sessions"
+           << G4endl;
+    return 1;
+  }
+#else
+  // Detect interactive mode (if no macro) and define UI session
   //
   G4UIExecutive* ui = nullptr;
-  if ( argc == 1 ) { ui = new G4UIExecutive(argc, argv); }
+  if ( macro.empty() ) { ui = new G4UIExecutive(argc, argv); }
+#endif
 
   // Optionally: choose a different Random engine...
   // G4Random::setTheEngine(new CLHEP::MTwistEngine);
@@ -59,9 +133,30 @@ int main(int argc,char** argv)
   G4int precision = 4;
   G4SteppingVerbose::UseBestUnit(precision);
 
+  // Time the startup phases from the state changes of the master
+  B2::StartupProfiler::Instance();
+
   // Construct the default run manager
   //
-  auto* runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::Default);
+  auto* runManager = G4RunManagerFactory::CreateRunManager(runManagerType);
+
+  // Default to the cores granted to the process (affinity mask and cgroup
+  // quota); /run/numberOfThreads in the macro still takes precedence
+  if ( runManager->GetRunManagerType() != G4RunManager::sequentialRM ) {
+    runManager->SetNumberOfThreads(B2::ThreadPlacement::Instance()->GetNumberOfAvailableCores());
+    runManager->SetUserInitialization(new B2::WorkerInitialization(xoshiroEngine));
+  }
+  else if ( xoshiroEngine ) {
+    // A single thread: the master engine generates the events itself
+    G4Random::setTheEngine(new B2::XoshiroEngine);
+  }
+
+  // Events handed to a worker (MT) or a task (tasking) at a time; 0 lets
+  // the run manager choose, /run/eventModulo in the macro also sets it
+  auto* mtRunManager = dynamic_cast<G4MTRunManager*>(runManager);
+  if ( mtRunManager && eventModulo >= 0 ) {
+    mtRunManager->SetEventModulo(eventModulo);
+  }
   G4ScoringManager* scoringManager = G4ScoringManager::GetScoringManager();
 
   // Set mandatory initialization classes
@@ -73,29 +168,36 @@ int main(int argc,char** argv)
 
   runManager->SetUserInitialization(physicsList);
 
+  // Tables of unchanged configurations come from /B2/run/physicsTableCache
+  B2::PhysicsTableCache::Instance()->SetPhysicsList(physicsList, "FTFP_BERT+G4StepLimiterPhysics");
+
   // Set user action classes
   runManager->SetUserInitialization(new B2::ActionInitialization());
 
-  // Initialize visualization
-  //
-  G4VisManager* visManager = new G4VisExecutive;
-  // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
-  // G4VisManager* visManager = new G4VisExecutive("Quiet");
-  visManager->Initialize();
-
   // Get the pointer to the User Interface manager
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
+#ifdef B2B_BATCH_ONLY
+  G4String command = "/control/execute ";
+  UImanager->ApplyCommand(command+macro);
+#else
   // Process macro or start UI session
   //
+  G4VisManager* visManager = nullptr;
   if ( ! ui ) {
-    // barch mode
+    // batch mode: no viewer is ever opened, so vis is not initialised
     G4String command = "/control/execute ";
-    G4String fileName = argv[1];
-    UImanager->ApplyCommand(command+fileName);
+    UImanager->ApplyCommand(command+macro);
   }
   else {
     // interactive mode
+    // Initialize visualization
+    //
+    visManager = new G4VisExecutive;
+    // G4VisExecutive can take a verbosity argument - see /vis/verbose guidance.
+    // G4VisManager* visManager = new G4VisExecutive("Quiet");
+    visManager->Initialize();
+
     UImanager->ApplyCommand("/control/execute init_vis.mac");
     if (ui->IsGUI()) {
       UImanager->ApplyCommand("/control/execute gui.mac");
@@ -103,13 +205,14 @@ int main(int argc,char** argv)
     ui->SessionStart();
     delete ui;
   }
+  delete visManager;
+#endif
 
   // Job termination
   // Free the store: user actions, physics_list and detector_description are
   // owned and deleted by the run manager, so they should not be deleted
   // in the main() program !
 
-  delete visManager;
   delete runManager;
 }
 
@@ -0,0 +1,163 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file histogramBench.cc
+/// \brief Compares the batched B2::Histogram1D fill with G4AnalysisManager::FillH1
+//
+// Usage: histogramBench [values]
+//
+// Fills the same values (default one million, spread over and beyond the
+// range and including every bin edge) into a G4AnalysisManager H1 with
+// FillH1() and into B2::Histogram1D, value by value and as one batch, for
+// the linear binning of the run histograms (200 bins, 0-10000 keV) and
+// the log binning of reduceNtuples (100 bins, 1e-5-1e4 keV). Prints the
+// fill rates and checks that every value lands in the same bin: the
+// entries and weight sums of all bins, under- and overflow included, must
+// be identical, also after adding the batch histogram to an empty H1.
+// Returns 1 if they differ.
+
+#include "Histogram.hh"
+
+#include "G4AnalysisManager.hh"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+template <class F>
+double Rate(std::size_t n, F fill)
+{
+  auto start = std::chrono::steady_clock::now();
+  fill();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return n / elapsed.count() * 1.e-6;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <class H1, class Axis>
+bool SameBins(const H1& h1, const B2::Histogram1D<Axis>& histogram)
+{
+  const auto& bins = histogram.GetBins();
+  if (h1.bins_entries().size() != bins.size()) return false;
+  for (std::size_t i = 0; i < bins.size(); ++i) {
+    if (h1.bins_entries()[i] != (unsigned int)bins[i].entries
+        || h1.bins_sum_w()[i] != bins[i].sumW || h1.bins_sum_w2()[i] != bins[i].sumW2) {
+      std::printf("  bin %zu: %u entries in the H1, %lld in the histogram\n",
+                  i, h1.bins_entries()[i], bins[i].entries);
+      return false;
+    }
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// The H1 is booked with the arguments of the axis
+template <class Axis>
+bool Compare(const std::string& name, const Axis& axis, double min, double max,
+             const std::string& binScheme, const std::vector<double>& values,
+             const std::vector<double>& weights)
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4int id = analysisManager->CreateH1(name, name, axis.GetNBins(), min, max,
+                                       "none", "none", binScheme);
+  G4int emptyId = analysisManager->CreateH1(name + "Sum", name, axis.GetNBins(), min, max,
+                                            "none", "none", binScheme);
+
+  std::size_t n = values.size();
+  B2::Histogram1D<Axis> single(axis), batch(axis);
+  double fillH1 = Rate(n, [&]() {
+    for (std::size_t i = 0; i < n; ++i) analysisManager->FillH1(id, values[i], weights[i]);
+  });
+  double fill = Rate(n, [&]() {
+    for (std::size_t i = 0; i < n; ++i) single.Fill(values[i], weights[i]);
+  });
+  double fillBatch = Rate(n, [&]() { batch.Fill(values.data(), n, weights.data()); });
+  batch.AddTo(*analysisManager->GetH1(emptyId));
+
+  auto h1 = analysisManager->GetH1(id);
+  bool ok = SameBins(*h1, single) && SameBins(*h1, batch)
+            && SameBins(*analysisManager->GetH1(emptyId), batch);
+  std::printf("%-8s %14.1f %14.1f %14.1f   %s\n", name.c_str(), fillH1, fill, fillBatch,
+              ok ? "same bins" : "DIFFERENT bins");
+  return ok;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  long n = argc > 1 ? std::atol(argv[1]) : 1000000;
+  if (n <= 0) {
+    std::fprintf(stderr, "Usage: %s [values]\n", argv[0]);
+    return 1;
+  }
+
+  B2::LinearAxis linear(200, 0., 10000.);
+  B2::LogAxis log(100, 1.e-5, 1.e4);
+
+  // Values over and beyond each range, every edge and its neighbours
+  std::mt19937_64 generator(12345);
+  std::vector<double> linearValues, logValues, weights;
+  std::uniform_real_distribution<double> flat(-500., 10500.), decades(-6., 5.);
+  std::uniform_real_distribution<double> weight(0.5, 2.);
+  for (long i = 0; i < n; ++i) {
+    linearValues.push_back(flat(generator));
+    logValues.push_back(std::pow(10., decades(generator)));
+    weights.push_back(weight(generator));
+  }
+  for (int k = 0; k <= 200; ++k) {
+    for (double x : { linear.GetEdge(k), std::nextafter(linear.GetEdge(k), -1.e300),
+                      std::nextafter(linear.GetEdge(k), 1.e300) }) {
+      linearValues.push_back(x);
+    }
+  }
+  for (int k = 0; k <= 100; ++k) {
+    for (double x : { log.GetEdge(k), std::nextafter(log.GetEdge(k), 0.),
+                      std::nextafter(log.GetEdge(k), 1.e300) }) {
+      logValues.push_back(x);
+    }
+  }
+  linearValues.resize(std::max(linearValues.size(), logValues.size()), 0.);
+  logValues.resize(linearValues.size(), 0.);
+  weights.resize(linearValues.size(), 1.);
+
+  std::printf("%-8s %14s %14s %14s   (M values/s, %zu values)\n", "binning", "FillH1",
+              "Fill", "Fill batch", linearValues.size());
+  bool ok = Compare("linear", linear, 0., 10000., "linear", linearValues, weights);
+  ok &= Compare("log", log, 1.e-5, 1.e4, "log", logValues, weights);
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/BeamProfile.hh
+/// \brief Definition of the B2::BeamProfile class
+
+#ifndef B2BeamProfile_h
+#define B2BeamProfile_h 1
+
+#include "globals.hh"
+#include "G4TwoVector.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+/// Transverse position of the primary protons on the beam spot.
+///
+/// A point of the unit square is mapped onto the selected profile:
+/// - radial: radius uniform up to fRadius (the original gun, denser at
+///   the centre)
+/// - disc:   uniform over the disc of radius fRadius
+/// - gauss:  round Gaussian of standard deviation fSigma (Box-Muller)
+/// - map:    measured 2D map; an alias table picks the cell from the first
+///           coordinate, whose remainder places the point across the cell,
+///           and the second coordinate places it along y
+///
+/// The unit square is sampled either with the thread's random engine or,
+/// to lower the variance of position-sensitive results, with a stratified
+/// (jittered fStrata x fStrata grid, one cell per sample and every cell
+/// once per block) or an Owen-scrambled 2D Sobol sequence, which repeats
+/// after 2^32 samples. The latter two are keyed on the sample index, the
+/// global event id times the primaries per event plus the primary, and
+/// scrambled with the master seed of B2::EventSeeder, so an event gets the
+/// same position whatever thread, shard or run segment processes it.
+///
+/// The settings are changed by the master between runs; the workers only
+/// read them.
+
+class BeamProfile
+{
+  public:
+    enum class Shape { Radial, Disc, Gauss, Map };
+    enum class Sampling { Pseudo, Stratified, Sobol };
+
+    static BeamProfile* Instance();
+
+    void SetShape(Shape shape);
+    Shape GetShape() const { return fShape; }
+    void SetRadius(G4double radius) { fRadius = radius; }
+    void SetSigma(G4double sigma) { fSigma = sigma; }
+    void SetSampling(Sampling sampling) { fSampling = sampling; }
+    Sampling GetSampling() const { return fSampling; }
+    void SetStrata(G4int n) { fStrata = n; }
+
+    // Text file: "xmin xmax ymin ymax" in mm, then one row of cell weights
+    // per y bin from ymin upwards; '#' starts a comment line
+    G4bool LoadMap(const G4String& fileName);
+
+    // Position of the sample with this index
+    G4TwoVector Sample(G4long index) const;
+
+  private:
+    BeamProfile() = default;
+
+    void GetUnitPoint(G4long index, G4double& u, G4double& v) const;
+    G4TwoVector SampleMap(G4double u, G4double v) const;
+
+    Shape fShape = Shape::Radial;
+    Sampling fSampling = Sampling::Pseudo;
+    G4double fRadius = 19.;  // mm, the internal length unit
+    G4double fSigma = 5.;    // mm
+    G4int fStrata = 32;
+
+    // Map: grid and Walker alias table of its cells
+    G4int fMapNx = 0;
+    G4int fMapNy = 0;
+    G4double fMapXMin = 0.;
+    G4double fMapYMin = 0.;
+    G4double fMapDx = 0.;
+    G4double fMapDy = 0.;
+    std::vector<G4double> fAliasProbability;
+    std::vector<G4int> fAlias;
+};
+
+}
+
+#endif
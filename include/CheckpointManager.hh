@@ -0,0 +1,162 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/CheckpointManager.hh
+/// \brief Definition of the B2::CheckpointManager class
+
+#ifndef B2CheckpointManager_h
+#define B2CheckpointManager_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <map>
+#include <vector>
+
+namespace B2
+{
+
+/// Periodic checkpoints of long runs and resume of interrupted runs.
+///
+/// A run is executed as a sequence of segments. Every fInterval each worker
+/// writes, on its next event, a self-contained file with the events it
+/// processed, its tally totals, its histograms, the number of rows of its
+/// ntuple file and its random engine state. Files are written to a
+/// temporary name and renamed, so a killed job always leaves the last
+/// complete file of every thread behind.
+///
+/// /B2/run/beamOn N starts a new run of N events or, when a manifest exists
+/// in the checkpoint directory, sums the files of the last segment into a
+/// baseline and runs the remaining events as a new segment. The ntuple
+/// files of the interrupted segment are cut back to the rows of the
+/// checkpoint, dropping the events processed after it, which may end in a
+/// partial row; the ntuple of a thread without a checkpoint file keeps only
+/// its header. The new segment draws its seeds from a part of the master
+/// engine stream which the interrupted segment could not have reached, and
+/// its event ids are shifted past those of all earlier segments, so the
+/// combined result is statistically equivalent to an uninterrupted run. As
+/// the Evt column of the ntuple is 32-bit, a run of N events can be resumed
+/// only as long as the number of segments times N stays below 2^31 (see
+/// B2::EventSeeder); a segment beyond this is refused. A run that finishes
+/// removes the manifest and the files of its segments, so the next
+/// /B2/run/beamOn with the same directory starts afresh.
+
+class CheckpointManager
+{
+  public:
+    static CheckpointManager* Instance();
+
+    void SetDirectory(const G4String& dir) { fDirectory = dir; }
+    void SetInterval(G4double seconds) { fInterval = seconds; }
+
+    // Master: run, or continue from the checkpoint, up to nEvents in total
+    void BeamOn(G4long nEvents);
+
+    // Called from the run and event actions of every thread; ntupleBase is
+    // the ntuple file name of the run without the thread suffix
+    void BeginOfRun(const G4String& ntupleBase);
+    void EndOfEvent(G4int eventID, G4long ntupleRows);
+    void EndOfRun();
+
+    // Master: add the histograms of earlier segments before writing them
+    void AddBaselineHistograms();
+
+    G4int GetSegment() const { return fSegment; }
+
+  private:
+    CheckpointManager();
+
+    struct Bin
+    {
+      G4double entries = 0.;
+      G4double sw = 0.;
+      G4double sw2 = 0.;
+      G4double sxw = 0.;
+      G4double sx2w = 0.;
+    };
+
+    // Content of one checkpoint file
+    struct State
+    {
+      G4long events = 0;
+      G4long maxEventID = -1;
+      G4double elapsed = 0.;
+      std::vector<G4String> tallyNames;
+      std::vector<G4double> tallySum;
+      std::vector<G4double> tallySum2;
+      G4long tallyHistories = 0;
+      std::vector<std::vector<Bin>> histograms;
+
+      void Add(const State& other);
+      void Write(std::ostream& os) const;
+      G4bool Read(std::istream& is);
+    };
+
+    struct ThreadCheckpoint
+    {
+      G4long events = 0;
+      G4long maxEventID = -1;
+      G4int writtenGeneration = 0;
+      G4String ntupleFile;
+      G4long ntupleRows = 0;
+    };
+
+    ThreadCheckpoint* GetThreadCheckpoint();
+    State CollectThreadState();
+    void WriteThreadFile();
+    void WriteManifest(G4long nEvents, const G4String& engineState);
+    G4bool ReadManifest(G4long& nEvents, G4String& ntupleBase, G4String& engineState);
+    void TruncateNtuples(const G4String& ntupleBase,
+                         const std::map<G4String, G4long>& ntupleRows) const;
+    void RemoveCheckpoint() const;
+    G4String GetThreadFileName(G4int segment, G4int threadId) const;
+    G4double GetElapsedTime() const;
+
+    static G4ThreadLocal ThreadCheckpoint* fgThreadCheckpoint;
+
+    mutable G4Mutex fMutex;
+
+    G4String fDirectory = "checkpoint";
+    G4double fInterval = 0.;  // seconds, 0 disables checkpointing
+
+    G4int fSegment = 0;
+    G4long fRequestedEvents = 0;
+    G4bool fActive = false;
+    G4String fNtupleBase;
+    State fBaseline;
+    G4bool fHasBaseline = false;
+
+    std::chrono::steady_clock::time_point fStartTime;
+    std::atomic<G4int> fGeneration{0};
+    std::atomic<G4double> fNextCheckpoint{0.};
+};
+
+}
+
+#endif
@@ -31,13 +31,18 @@
 #define B2bDetectorConstruction_h 1
 
 #include "globals.hh"
+#include "G4RotationMatrix.hh"
 #include "G4VUserDetectorConstruction.hh"
 #include "tls.hh"
 
+#include <memory>
+#include <vector>
+
 class G4VPhysicalVolume;
 class G4LogicalVolume;
 class G4Material;
 class G4UserLimits;
+class G4VisAttributes;
 class G4GlobalMagFieldMessenger;
 
 namespace B2b
@@ -47,6 +52,17 @@ class DetectorMessenger;
 
 /// Detector construction class to define materials, geometry
 /// and global uniform magnetic field.
+///
+/// The sensitive volumes are listed in one table (fSensitiveVolumes): it
+/// defines their tallies and, in every thread, their TrackerSD and entry
+/// in B2::DetectorRegistry. Adding a detector means adding its volume and
+/// a row to this table, plus booking its spectrum in B2::RunAction.
+///
+/// Construct() can run again in the same process, after a geometry
+/// reinitialisation such as /B2/det/setModeratorThickness: the materials
+/// are defined once and looked up afterwards, the previous volumes are
+/// deleted from the geometry stores, and the vis attributes, rotation and
+/// step limits are owned by this class instead of being allocated anew.
 
 class DetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -62,11 +78,29 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     void SetTargetMaterial (G4String );
     void SetChamberMaterial(G4String );
     void SetMaxStep (G4double );
+    void SetModeratorThickness(G4double );
     void SetCheckOverlaps(G4bool );
+    void SetOverlapCache(G4String );
+    void SetHitMode(G4String );
+
+    // Get methods
+    G4double GetModeratorThickness() const { return fModeratorThickness; }
+    const G4Material* GetTargetMaterial() const { return fTargetMaterial; }
+    const G4Material* GetModeratorMaterial() const { return fModeratorMaterial; }
 
   private:
+    struct SensitiveVolume
+    {
+      G4LogicalVolume* logical = nullptr;
+      G4String name;          // physical volume and tally name
+      G4int number = -1;      // Detector column of the ntuple
+      G4String spectrumName;  // histogram of the first neutron per primary
+      G4bool placed = true;   // false for a volume left out of this geometry
+    };
+
     // methods
     void DefineMaterials();
+    void BuildMaterials();
     G4VPhysicalVolume* DefineVolumes();
 
     // static data members
@@ -89,11 +123,20 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     G4Material*       fBertholdMaterial = nullptr;
     G4Material*       fWorldMaterial = nullptr;
 
+    G4double fModeratorThickness = 0.; // full thickness, 0 without moderator
+    G4double fModeratorThicknessSetting = -1.; // from the command, < 0 for the environment
+
+    G4RotationMatrix fTubeRotation; // of the Berthold tube
+    std::vector<std::unique_ptr<G4VisAttributes>> fVisAttributes;
+
+    std::vector<SensitiveVolume> fSensitiveVolumes;
+
     G4UserLimits* fStepLimit = nullptr; // pointer to user step limits
 
     DetectorMessenger* fMessenger = nullptr; // messenger
 
     G4bool fCheckOverlaps = true; // option to activate checking of volumes overlaps
+    G4String fOverlapCache = "overlaps.cache"; // verified placements, empty for none
 };
 
 }
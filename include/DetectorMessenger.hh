@@ -34,6 +34,7 @@
 #include "G4UImessenger.hh"
 
 class G4UIdirectory;
+class G4UIcmdWithABool;
 class G4UIcmdWithAString;
 class G4UIcmdWithADoubleAndUnit;
 
@@ -48,6 +49,10 @@ class DetectorConstruction;
 /// - /B2/det/setTargetMaterial name
 /// - /B2/det/setChamberMaterial name
 /// - /B2/det/stepMax value unit
+/// - /B2/det/setModeratorThickness value unit
+/// - /B2/det/hitMode step|track
+/// - /B2/det/checkOverlaps true|false
+/// - /B2/det/overlapCache fileName|none
 
 class DetectorMessenger: public G4UImessenger
 {
@@ -67,6 +72,10 @@ class DetectorMessenger: public G4UImessenger
     G4UIcmdWithAString*    fChamMatCmd = nullptr;
 
     G4UIcmdWithADoubleAndUnit* fStepMaxCmd = nullptr;
+    G4UIcmdWithADoubleAndUnit* fModeratorThicknessCmd = nullptr;
+    G4UIcmdWithAString*    fHitModeCmd = nullptr;
+    G4UIcmdWithABool*      fCheckOverlapsCmd = nullptr;
+    G4UIcmdWithAString*    fOverlapCacheCmd = nullptr;
 };
 
 }
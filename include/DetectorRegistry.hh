@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/DetectorRegistry.hh
+/// \brief Definition of the B2::DetectorRegistry class
+
+#ifndef B2DetectorRegistry_h
+#define B2DetectorRegistry_h 1
+
+#include "globals.hh"
+#include "tls.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+/// Sensitive detectors of the thread and what is scored in them.
+///
+/// DetectorConstruction::ConstructSDandField() registers every sensitive
+/// volume of its table with the hits collection of its TrackerSD, and the
+/// run action resolves the histogram ids once they are booked. Detectors
+/// get dense ids in registration order, so the event action walks one
+/// flat array instead of hard-coded collection and histogram indices.
+/// The registry is per thread, like the sensitive detectors themselves.
+
+class DetectorRegistry
+{
+  public:
+    struct Detector
+    {
+      G4String name;          // physical volume, also the tally name
+      G4int number = -1;      // Detector column of the ntuple
+      G4String spectrumName;  // histogram of the first neutron per primary
+      G4int hitsCollectionId = -1;
+      G4int tallyId = -1;
+      G4int spectrumId = -1;
+      G4bool placed = true;   // an unplaced volume is never entered
+    };
+
+    // Registry of the calling thread
+    static DetectorRegistry* Instance();
+
+    // Detector construction
+    void Clear() { fDetectors.clear(); }
+    G4int Register(const G4String& name, G4int number, const G4String& spectrumName,
+                   G4int hitsCollectionId, G4bool placed = true);
+
+    // After the histograms are booked
+    void ResolveHistograms();
+
+    const std::vector<Detector>& GetDetectors() const { return fDetectors; }
+    std::size_t GetNumberOfDetectors() const { return fDetectors.size(); }
+    std::size_t GetNumberOfPlacedDetectors() const;
+    const G4String& GetName(G4int number) const;
+
+  private:
+    DetectorRegistry() = default;
+    ~DetectorRegistry() = default;
+
+    static G4ThreadLocal DetectorRegistry* fgInstance;
+
+    std::vector<Detector> fDetectors;
+};
+
+}
+
+#endif
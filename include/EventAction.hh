@@ -34,10 +34,15 @@
 
 #include "globals.hh"
 
+#include <vector>
+
 namespace B2
 {
 
 /// Event action class
+///
+/// Fills the histograms, ntuple and tallies from the hits of every
+/// detector of B2::DetectorRegistry.
 
 class EventAction : public G4UserEventAction
 {
@@ -47,8 +52,11 @@ class EventAction : public G4UserEventAction
 
     void  BeginOfEventAction(const G4Event* ) override;
     void    EndOfEventAction(const G4Event* ) override;
-  
+
   private:
+    // Per detector of the registry: primaries of the current event that
+    // already scored its tally
+    std::vector<std::vector<G4bool>> fScored;
 };
 
 }
@@ -0,0 +1,106 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/EventSeeder.hh
+/// \brief Definition of the B2::EventSeeder class
+
+#ifndef B2EventSeeder_h
+#define B2EventSeeder_h 1
+
+#include "globals.hh"
+
+namespace B2
+{
+
+/// Global event numbering, sharding and per-event seeding.
+///
+/// /B2/run/beamOn N splits the N events of a configuration into the
+/// contiguous id range of this process' shard (--shard i/n on the command
+/// line), so n processes together simulate exactly the events of a single
+/// process. Event ids seen by the user actions are offset accordingly, and
+/// by a multiple of N for every resumed segment, so that they stay unique
+/// across shards and segments. The ids are 64-bit, but the Evt column of
+/// the ntuple is a 32-bit int, as G4AnalysisManager has no long column: a
+/// run numbers at most 2^31 - 1 events over all its segments, i.e. the
+/// k-th resumed segment needs (k + 1) N < 2^31, and a segment beyond this
+/// is refused. In the per-event seeding mode the random engine of the
+/// thread processing an event is reseeded from the master seed and the
+/// global event id before the primaries are generated.
+/// With the default MixMax engine the four seeds select non-overlapping
+/// streams (seed_uniquestream), so every event sees the same random numbers
+/// whatever the number of threads and the order in which they pick events.
+/// The same holds with --rng xoshiro, whose streams are independent with
+/// overwhelming probability rather than by construction.
+/// In the default mode each shard seeds the master engine with its own
+/// stream instead.
+
+class EventSeeder
+{
+  public:
+    enum class Mode { Default, PerEvent };
+
+    static EventSeeder* Instance();
+
+    void SetMode(Mode mode) { fMode = mode; }
+    Mode GetMode() const { return fMode; }
+    void SetMasterSeed(G4long seed) { fMasterSeed = seed; }
+    G4long GetMasterSeed() const { return fMasterSeed; }
+
+    void SetEventIdOffset(G4long offset) { fEventIdOffset = offset; }
+    G4long GetEventIdOffset() const { return fEventIdOffset; }
+    G4long GetGlobalEventID(G4int eventID) const { return fEventIdOffset + eventID; }
+
+    // Events of the whole configuration, across all shards
+    G4long GetTotalEvents() const { return fTotalEvents; }
+
+    void SetShard(G4int index, G4int nShards);
+    G4int GetShardIndex() const { return fShardIndex; }
+    G4int GetNumberOfShards() const { return fNumberOfShards; }
+    G4String GetShardSuffix() const;
+
+    // Master: run this shard's part of nEvents, resuming if checkpointed
+    void BeamOn(G4long nEvents);
+
+    // Worker: reseed the thread engine for this event (per-event mode only)
+    void SeedEvent(G4int eventID) const;
+
+    // Master: process the single event with this global id again
+    void ReplayEvent(G4long globalEventID);
+
+  private:
+    EventSeeder() = default;
+
+    Mode fMode = Mode::Default;
+    G4long fMasterSeed = 12345;
+    G4long fEventIdOffset = 0;
+    G4long fTotalEvents = 0;
+    G4int fShardIndex = 0;
+    G4int fNumberOfShards = 1;
+};
+
+}
+
+#endif
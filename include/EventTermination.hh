@@ -0,0 +1,108 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/EventTermination.hh
+/// \brief Definition of the B2::EventTermination class
+
+#ifndef B2EventTermination_h
+#define B2EventTermination_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+
+class G4Event;
+class G4Track;
+
+namespace B2
+{
+
+/// Early end of the events whose tallies can no longer change.
+///
+/// The spectra and tallies only take the first neutron each primary sends
+/// into a detector. In the FirstEntry mode the event is final once every
+/// primary has reached every placed detector of B2::DetectorRegistry: the
+/// track making the last first entry is killed with its secondaries and
+/// the stacks are cleared. B2::StackingAction tracks the neutrons first so
+/// this happens before the long electromagnetic and thermal tails are
+/// followed. The per-hit histograms and ntuple rows only cover the hits
+/// made before the event ended. Terminated events and skipped tracks are
+/// counted by B2::RunStatistics.
+///
+/// Tracking the neutrons first changes the order of the tracks, and so the
+/// random numbers each one draws and which neutron of a primary is the
+/// first to enter a detector. The tallies and E* spectra of FirstEntry are
+/// statistically but not event by event those of None. The NeutronsFirst
+/// mode uses the same order without ending the events: with the same seeds
+/// it gives exactly the tallies and spectra of FirstEntry, which
+/// check_termination.sh verifies.
+
+class EventTermination
+{
+  public:
+    enum class Mode { None, NeutronsFirst, FirstEntry };
+
+    static EventTermination* Instance();
+
+    // Applies from the next event on, in all threads
+    static void SetMode(Mode mode) { fgMode = mode; }
+    static Mode GetMode() { return fgMode; }
+
+    // Thread processing the event
+    void BeginOfEvent(const G4Event* event);
+    G4bool IsNeutronsFirst() const { return GetThreadState()->neutronsFirst; }
+    G4bool IsActive() const { return GetThreadState()->active; }
+    G4bool IsTerminated() const { return GetThreadState()->terminated; }
+    G4long GetSkippedTracks() const { return GetThreadState()->skipped; }
+
+    // Sensitive detector: the first neutron of a primary in one detector
+    void FirstEntry(G4Track* track);
+
+    // Stacking action: a new track of a terminated event is dropped
+    void SkipTrack() { ++GetThreadState()->skipped; }
+
+  private:
+    EventTermination() = default;
+    ~EventTermination() = default;
+
+    struct ThreadState
+    {
+      G4bool neutronsFirst = false;  // mode latched at the start of the event
+      G4bool active = false;
+      G4bool terminated = false;
+      G4long pending = 0;     // primary and detector pairs without an entry
+      G4long skipped = 0;
+    };
+
+    static ThreadState* GetThreadState();
+
+    static G4ThreadLocal ThreadState* fgThreadState;
+    static std::atomic<Mode> fgMode;
+};
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/FileStore.hh
+/// \brief Definition of the B2::FileStore class
+
+#ifndef B2FileStore_h
+#define B2FileStore_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace B2
+{
+
+/// Files and directories shared between threads and processes.
+///
+/// The checkpoints, the overlap cache and the physics table cache are
+/// written under a temporary name, unique to the process, and renamed over
+/// their target, so that a reader, a concurrent job or a later start never
+/// sees a partial file. Their keys are 64-bit FNV-1a hashes of a text.
+
+class FileStore
+{
+  public:
+    // 64-bit FNV-1a hash of a text
+    static std::uint64_t Hash(const std::string& text);
+
+    // Replaces fileName by content; false if it cannot be written
+    static G4bool WriteFile(const G4String& fileName, const std::string& content);
+
+    // Creates directory from what fill() writes into the temporary directory
+    // it is given; false if fill() fails or the directory already exists,
+    // e.g. because a concurrent process stored it first
+    static G4bool StoreDirectory(const G4String& directory,
+                                 const std::function<G4bool(const G4String&)>& fill);
+
+  private:
+    FileStore() = delete;
+};
+
+}
+
+#endif
@@ -0,0 +1,272 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/Histogram.hh
+/// \brief Definition of the B2::Histogram1D class and its axes
+
+#ifndef B2Histogram_h
+#define B2Histogram_h 1
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace B2
+{
+
+/// Header-only one-dimensional histograms with batched filling.
+///
+/// The bins are numbered like those of tools::histo, which backs
+/// G4AnalysisManager::FillH1(): 0 is the underflow, 1..n the bins and n+1
+/// the overflow, and a value goes to the same bin as it would there:
+/// LinearAxis repeats the arithmetic of the fixed-width tools axis and
+/// LogAxis computes its edges like the "log" bin scheme of G4Analysis and
+/// compares with them. NaN goes to the underflow.
+///
+/// Fill() of an array first computes the bin indices of a chunk of values,
+/// in a branch-free loop that the compiler vectorises (at -O3) for
+/// LinearAxis, then accumulates the chunk. It only uses the standard
+/// library, so the offline tools share it with the application.
+
+/// Fixed-width bins between min and max
+class LinearAxis
+{
+  public:
+    LinearAxis() = default;
+    LinearAxis(int nBins, double min, double max)
+      : fNBins(nBins), fMin(min), fMax(max), fWidth((max - min) / nBins)
+    {}
+
+    int GetNBins() const { return fNBins; }
+    // Lower edge of the bin k+1, k = 0..n
+    double GetEdge(int k) const { return k == fNBins ? fMax : fMin + k * fWidth; }
+
+    int Index(double x) const
+    {
+      if ( ! (x >= fMin) ) return 0;
+      if (x >= fMax) return fNBins + 1;
+      return int((x - fMin) / fWidth) + 1;
+    }
+
+    void Indices(const double* x, std::size_t n, int* index) const
+    {
+      const double last = fNBins;
+      for (std::size_t i = 0; i < n; ++i) {
+        // Clamped first so that the conversion is defined for any value
+        double t = std::min(std::max(0., (x[i] - fMin) / fWidth), last);
+        int bin = x[i] >= fMin ? int(t) + 1 : 0;
+        index[i] = x[i] >= fMax ? fNBins + 1 : bin;
+      }
+    }
+
+  private:
+    int fNBins = 0;
+    double fMin = 0.;
+    double fMax = 0.;
+    double fWidth = 1.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Bins of equal width in log(x), i.e. in lethargy, between min > 0 and max
+class LogAxis
+{
+  public:
+    LogAxis() = default;
+    LogAxis(int nBins, double min, double max)
+      : fNBins(nBins), fEdges(nBins + 1)
+    {
+      // Each edge is the previous one times (max/min)^(1/n), as G4Analysis
+      // builds them, so the last edge may differ from max by rounding
+      double dlog = (std::log10(max) - std::log10(min)) / nBins;
+      double factor = std::pow(10., dlog);
+      double edge = min;
+      for (auto& e : fEdges) {
+        e = edge;
+        edge *= factor;
+      }
+      fLog2Min = std::log2(min);
+      fBinsPerLog2 = 1. / (dlog * std::log2(10.));
+    }
+
+    int GetNBins() const { return fNBins; }
+    double GetEdge(int k) const { return fEdges[k]; }
+    // Lethargy width ln(high/low) of the bin 1..n
+    double GetLethargy(int bin) const { return std::log(fEdges[bin] / fEdges[bin - 1]); }
+
+    int Index(double x) const
+    {
+      if ( ! (x >= fEdges.front()) ) return 0;
+      if (x >= fEdges.back()) return fNBins + 1;
+      return Refine(x, Guess(x));
+    }
+
+    void Indices(const double* x, std::size_t n, int* index) const
+    {
+      for (std::size_t i = 0; i < n; ++i) index[i] = Guess(x[i]);
+      // The guess is corrected against the edges; values out of range stop
+      // at the first or last bin and then go to the under- or overflow
+      for (std::size_t i = 0; i < n; ++i) {
+        double value = x[i];
+        int k = index[i];
+        while (k > 0 && value < fEdges[k]) --k;
+        while (k < fNBins - 1 && value >= fEdges[k + 1]) ++k;
+        int bin = value >= fEdges.front() ? k + 1 : 0;
+        index[i] = value >= fEdges.back() ? fNBins + 1 : bin;
+      }
+    }
+
+  private:
+    // Bin 0..n-1 within a few bins of the right one, from the exponent
+    // bits and a quadratic fit of log2 of the mantissa (error < 0.01)
+    int Guess(double x) const
+    {
+      std::uint64_t bits;
+      std::memcpy(&bits, &x, sizeof(bits));
+      double exponent = double(int((bits >> 52) & 0x7ff) - 1023);
+      std::uint64_t mantissaBits = (bits & 0x000fffffffffffffULL) | 0x3ff0000000000000ULL;
+      double m;
+      std::memcpy(&m, &mantissaBits, sizeof(m));
+      double t = m - 1.;
+      double log2 = exponent + t * (4. / 3. - t / 3.);
+      double bin = (log2 - fLog2Min) * fBinsPerLog2;
+      return int(std::min(std::max(0., bin), double(fNBins - 1)));
+    }
+
+    // Exact bin 1..n by comparing with the edges, x in [front, back)
+    int Refine(double x, int k) const
+    {
+      while (x < fEdges[k]) --k;
+      while (x >= fEdges[k + 1]) ++k;
+      return k + 1;
+    }
+
+    int fNBins = 0;
+    std::vector<double> fEdges;
+    double fLog2Min = 0.;
+    double fBinsPerLog2 = 0.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+/// Per-bin entries, sums of weights and of squared weights and the x
+/// moments of the bins, as kept by tools::histo::h1d
+template <class Axis>
+class Histogram1D
+{
+  public:
+    // The sums of a bin share a cache line
+    struct Bin
+    {
+      long long entries = 0;
+      double sumW = 0.;
+      double sumW2 = 0.;
+      double sumXW = 0.;
+      double sumX2W = 0.;
+    };
+
+    Histogram1D() = default;
+    explicit Histogram1D(const Axis& axis) : fAxis(axis), fBins(axis.GetNBins() + 2) {}
+
+    void Fill(double x, double weight = 1.) { Accumulate(fAxis.Index(x), x, weight); }
+
+    // Fills n values with their weights, or with weight 1 if there are none
+    void Fill(const double* x, std::size_t n, const double* weights = nullptr)
+    {
+      int index[kChunk];
+      for (std::size_t start = 0; start < n; start += kChunk) {
+        std::size_t size = std::min(kChunk, n - start);
+        fAxis.Indices(x + start, size, index);
+        if (weights) {
+          for (std::size_t i = 0; i < size; ++i) {
+            Accumulate(index[i], x[start + i], weights[start + i]);
+          }
+        }
+        else {
+          for (std::size_t i = 0; i < size; ++i) Accumulate(index[i], x[start + i], 1.);
+        }
+      }
+    }
+
+    // Sums the bins of a histogram with the same axis
+    void Add(const Histogram1D& other)
+    {
+      for (std::size_t i = 0; i < fBins.size(); ++i) {
+        const Bin& bin = other.fBins[i];
+        fBins[i].entries += bin.entries;
+        fBins[i].sumW += bin.sumW;
+        fBins[i].sumW2 += bin.sumW2;
+        fBins[i].sumXW += bin.sumXW;
+        fBins[i].sumX2W += bin.sumX2W;
+      }
+    }
+
+    // Sums the bins into a tools::histo::h1d of the same binning, e.g. the
+    // one of G4AnalysisManager::GetH1()
+    template <class H1>
+    void AddTo(H1& h1) const
+    {
+      for (unsigned int i = 0; i < fBins.size(); ++i) {
+        const Bin& bin = fBins[i];
+        h1.set_bin_content(i,
+                           h1.bins_entries()[i] + (unsigned int)bin.entries,
+                           h1.bins_sum_w()[i] + bin.sumW,
+                           h1.bins_sum_w2()[i] + bin.sumW2,
+                           h1.bins_sum_xw()[i][0] + bin.sumXW,
+                           h1.bins_sum_x2w()[i][0] + bin.sumX2W);
+      }
+    }
+
+    void Reset() { std::fill(fBins.begin(), fBins.end(), Bin()); }
+
+    const Axis& GetAxis() const { return fAxis; }
+    int GetNBins() const { return fAxis.GetNBins(); }
+    // Bins 0..n+1, with the underflow first and the overflow last
+    const std::vector<Bin>& GetBins() const { return fBins; }
+
+  private:
+    static constexpr std::size_t kChunk = 256;
+
+    void Accumulate(int index, double x, double weight)
+    {
+      Bin& bin = fBins[index];
+      ++bin.entries;
+      bin.sumW += weight;
+      bin.sumW2 += weight * weight;
+      bin.sumXW += x * weight;
+      bin.sumX2W += x * x * weight;
+    }
+
+    Axis fAxis;
+    std::vector<Bin> fBins;
+};
+
+}
+
+#endif
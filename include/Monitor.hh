@@ -0,0 +1,141 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/Monitor.hh
+/// \brief Definition of the B2::Monitor class
+
+#ifndef B2Monitor_h
+#define B2Monitor_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+
+namespace B2
+{
+
+/// Embedded HTTP monitor of a running simulation.
+///
+/// When a port is set with /B2/monitor/port, a server thread answers GET
+/// requests on 127.0.0.1:port with JSON documents:
+/// - /status   run, elapsed time, events and rate, per-thread progress and
+///             the tallies with their relative error
+/// - /h1       names of the histograms
+/// - /h1/name  bins of a histogram summed over all threads
+/// GET requests only read. POST /stop?token=<token> asks the run to stop
+/// after the current events, like a reached tally target, so its outputs
+/// are still written. The token is drawn when the monitor starts and only
+/// printed to the output of the job, so neither a web page nor another
+/// user of the node can stop the run.
+/// Workers never block on the monitor: every fInterval seconds each one
+/// copies its event count and histogram bins into its own snapshot slot,
+/// and requests are served from these copies. Histograms cover the current
+/// run segment only.
+
+class Monitor
+{
+  public:
+    static Monitor* Instance();
+
+    // Master: start serving on the port (0 stops)
+    void SetPort(G4int port);
+    void SetInterval(G4double seconds) { fInterval = seconds; }
+    void Stop();
+    G4bool IsActive() const { return fActive; }
+
+    // Called from every thread's run action
+    void BeginOfRun(G4int runID, G4int nEvents);
+    void EndOfRun();
+
+    // Thread processing the event
+    void EndOfEvent()
+    {
+      if (fActive.load(std::memory_order_relaxed)) CountEvent();
+    }
+
+  private:
+    Monitor() = default;
+    ~Monitor();
+
+    using Clock = std::chrono::steady_clock;
+
+    struct HistogramSnapshot
+    {
+      G4String name;
+      G4int nBins = 0;
+      G4double min = 0.;
+      G4double max = 0.;
+      std::vector<G4double> entries;  // with under- and overflow
+      std::vector<G4double> sumW;
+    };
+
+    struct ThreadSnapshot
+    {
+      G4long events = 0;
+      Clock::time_point time;
+      std::vector<HistogramSnapshot> histograms;
+    };
+
+    struct ThreadState
+    {
+      G4long events = 0;
+      Clock::time_point lastSnapshot;
+    };
+
+    void CountEvent();
+    void TakeSnapshot(ThreadState* state);
+    void Serve();
+    void HandleRequest(int client);
+    G4String GetStatus();
+    G4String GetHistogram(const G4String& name);
+    G4String GetHistogramNames();
+
+    static G4ThreadLocal ThreadState* fgThreadState;
+
+    G4double fInterval = 1.;  // seconds between snapshots of a thread
+    std::atomic<G4bool> fActive{false};
+    std::atomic<G4bool> fServing{false};
+    std::thread fServer;
+    int fSocket = -1;
+    G4int fPort = 0;
+    G4String fStopToken;
+
+    G4Mutex fMutex;  // guards the snapshots and the run state below
+    std::map<G4int, ThreadSnapshot> fSnapshots;
+    G4int fRunID = -1;
+    G4int fRequestedEvents = 0;
+    G4bool fRunning = false;
+    Clock::time_point fRunStart;
+};
+
+}
+
+#endif
@@ -0,0 +1,99 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/OverlapChecker.hh
+/// \brief Definition of the B2::OverlapChecker class
+
+#ifndef B2OverlapChecker_h
+#define B2OverlapChecker_h 1
+
+#include "globals.hh"
+
+#include <cstdint>
+#include <ostream>
+#include <set>
+#include <vector>
+
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+
+namespace B2
+{
+
+/// Overlap check of the placed volumes, skipping those already verified.
+///
+/// Each placement is fingerprinted by what its CheckOverlaps() depends on:
+/// its solid, translation and rotation, the solid of its mother, the same
+/// description of all its sisters and the check parameters. Fingerprints
+/// found without overlaps are added to a cache file, so an unchanged
+/// geometry skips the check while a moved or resized placement, and its
+/// sisters, are checked again. Placements with overlaps are never cached
+/// and are reported at every start; replicated and parameterised volumes
+/// are always checked. The cache is rewritten through a temporary file
+/// and a rename. An empty file name disables the cache.
+
+class OverlapChecker
+{
+  public:
+    explicit OverlapChecker(const G4String& cacheFile,
+                            G4int resolution = 1000, G4double tolerance = 0.)
+      : fCacheFile(cacheFile), fResolution(resolution), fTolerance(tolerance) {}
+
+    // Checks the daughters below the world and updates the cache file
+    void Check(G4VPhysicalVolume* world);
+
+    G4int GetNumberOfOverlaps() const { return fOverlaps; }
+    // One line for the startup table
+    G4String GetSummary() const;
+
+  private:
+    struct Entry
+    {
+      std::uint64_t fingerprint = 0;
+      G4String name;
+    };
+
+    void Visit(const G4LogicalVolume* mother, std::set<const G4LogicalVolume*>& visited);
+    std::uint64_t Fingerprint(const G4VPhysicalVolume* volume,
+                              const G4LogicalVolume* mother) const;
+    static void Describe(std::ostream& os, const G4VPhysicalVolume* volume);
+    void ReadCache();
+    void WriteCache() const;
+
+    G4String fCacheFile;
+    G4int fResolution = 1000;
+    G4double fTolerance = 0.;
+
+    std::set<std::uint64_t> fCached;
+    std::vector<Entry> fVerified; // new entries for the cache
+    G4int fChecked = 0;
+    G4int fSkipped = 0;
+    G4int fOverlaps = 0;
+};
+
+}
+
+#endif
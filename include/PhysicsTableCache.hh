@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/PhysicsTableCache.hh
+/// \brief Definition of the B2::PhysicsTableCache class
+
+#ifndef B2PhysicsTableCache_h
+#define B2PhysicsTableCache_h 1
+
+#include "globals.hh"
+#include "G4VStateDependent.hh"
+
+class G4VUserPhysicsList;
+
+namespace B2
+{
+
+/// Physics tables stored on the first run and retrieved by later processes.
+///
+/// When the master enters the Init state of a run initialisation, the
+/// configuration the tables depend on is described and hashed: the physics
+/// list name, the Geant4 version, the EM parameters, every material with
+/// its elements and the production cuts of every region. If the cache
+/// directory holds a complete entry for this key the physics list is set
+/// to retrieve its tables from it, otherwise the tables are built and the
+/// master stores them at the start of the run. An entry is written to a
+/// temporary directory and renamed when complete, so concurrent processes
+/// never read a partial entry; the key.txt file of an entry holds the
+/// description it was hashed from. Geant4 checks the retrieved cuts table
+/// against the current couples and rebuilds the tables it cannot retrieve.
+///
+/// Only the tables with store/retrieve support (cuts, electromagnetic
+/// processes) are cached; hadronic cross sections are always computed.
+/// The instance registers with the master G4StateManager, which deletes it.
+
+class PhysicsTableCache : public G4VStateDependent
+{
+  public:
+    static PhysicsTableCache* Instance();
+
+    // Master physics list and the name of its constructors
+    void SetPhysicsList(G4VUserPhysicsList* physicsList, const G4String& name);
+    // Empty disables the cache
+    void SetDirectory(const G4String& directory) { fDirectory = directory; }
+    const G4String& GetDirectory() const { return fDirectory; }
+
+    // Master run action: stores the tables just built
+    void BeginOfRun();
+
+    G4bool Notify(G4ApplicationState requestedState) override;
+
+  private:
+    PhysicsTableCache() = default;
+
+    G4String Describe() const;
+
+    G4String fDirectory = "physics_tables";
+    G4VUserPhysicsList* fPhysicsList = nullptr;
+    G4String fName;
+
+    // Entry of the last run initialisation, empty once retrieved or stored
+    G4String fEntry;
+    G4String fDescription;
+};
+
+}
+
+#endif
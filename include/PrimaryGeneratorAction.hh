@@ -33,6 +33,8 @@
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include "globals.hh"
 
+#include <atomic>
+
 class G4ParticleGun;
 class G4Event;
 
@@ -45,6 +47,9 @@ namespace B2
 /// perpendicular to the input face. The type of the particle
 /// can be changed via the G4 build-in commands of G4ParticleGun class
 /// (see the macros provided with this example).
+/// With /B2/run/primariesPerEvent K each event holds K such particles, each
+/// with its own vertex, so the per-event cost is shared by K histories.
+/// B2::BeamProfile gives the transverse position of every primary.
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
@@ -56,11 +61,18 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 
     G4ParticleGun* GetParticleGun() {return fParticleGun;}
 
+    // Applies from the next event on, in all threads
+    static void SetPrimariesPerEvent(G4int n) { fgPrimariesPerEvent = n; }
+    static G4int GetPrimariesPerEvent() { return fgPrimariesPerEvent; }
+
     // Set methods
     void SetRandomFlag(G4bool );
 
   private:
     G4ParticleGun* fParticleGun = nullptr; // G4 particle gun
+    G4bool fWorldChecked = false;
+
+    static std::atomic<G4int> fgPrimariesPerEvent;
 };
 
 }
@@ -0,0 +1,78 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/PrimaryIndex.hh
+/// \brief Definition of the B2::PrimaryIndex class
+
+#ifndef B2PrimaryIndex_h
+#define B2PrimaryIndex_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class G4Track;
+
+namespace B2
+{
+
+/// Primary particle every track of the event descends from.
+///
+/// With several primaries per event (/B2/run/primariesPerEvent) the hits
+/// and the tallies are attributed to the primary proton they come from.
+/// Geant4 gives the primaries the track ids 1..K in the order they were
+/// generated, and a secondary starts tracking after its parent, so a
+/// per-event table indexed by track id, filled in PreUserTrackingAction,
+/// resolves the primary of any track without attaching information to it.
+
+class PrimaryIndex
+{
+  public:
+    static PrimaryIndex* Instance();
+
+    // Thread processing the event
+    void BeginOfEvent() { GetThreadTable()->clear(); }
+    void StartTrack(const G4Track* track);
+
+    // Primary index 0..K-1 of a track
+    G4int GetPrimary(G4int trackID) const
+    {
+      auto table = GetThreadTable();
+      return trackID < G4int(table->size()) ? (*table)[trackID] : 0;
+    }
+
+  private:
+    PrimaryIndex() = default;
+    ~PrimaryIndex() = default;
+
+    static std::vector<G4int>* GetThreadTable();
+
+    static G4ThreadLocal std::vector<G4int>* fgPrimaryOfTrack;
+};
+
+}
+
+#endif
@@ -38,16 +38,30 @@ class G4Run;
 namespace B2
 {
 
+class RunMessenger;
+
 /// Run action class
+///
+/// The master instance owns the run control messenger. Every instance
+/// books the histograms and ntuple and points the detectors of
+/// B2::DetectorRegistry to their spectra.
 
 class RunAction : public G4UserRunAction
 {
   public:
     RunAction();
-    ~RunAction() override = default;
+    ~RunAction() override;
 
     void BeginOfRunAction(const G4Run* run) override;
     void   EndOfRunAction(const G4Run* run) override;
+
+    // Histograms and ntuple of the calling thread, also booked by actionBench
+    static void Book();
+
+  private:
+
+    RunMessenger* fMessenger = nullptr;
+    G4String fFileBase;  // output file name without extension
 };
 
 }
@@ -0,0 +1,142 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/RunMessenger.hh
+/// \brief Definition of the B2::RunMessenger class
+
+#ifndef B2RunMessenger_h
+#define B2RunMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAnInteger;
+
+namespace B2
+{
+
+/// Messenger class that defines the run control commands.
+///
+/// It implements commands:
+/// - /B2/run/targetRelError value
+/// - /B2/run/stopTallies names
+/// - /B2/run/maxWallTime value unit
+/// - /B2/run/printInterval value unit
+/// - /B2/run/flushInterval histories
+/// - /B2/run/seedMode default|event
+/// - /B2/run/masterSeed seed
+/// - /B2/run/replayEvent eventID
+/// - /B2/run/beamOn nEvents
+/// - /B2/run/primariesPerEvent nPrimaries
+/// - /B2/run/pinning none|compact|numa
+/// - /B2/run/physicsTableCache path|none
+/// - /B2/run/earlyTermination none|firstEntry
+/// - /B2/checkpoint/directory path
+/// - /B2/checkpoint/interval value unit
+/// - /B2/checkpoint/beamOn nEvents (alias of /B2/run/beamOn)
+/// - /B2/profile/enable [true|false]
+/// - /B2/profile/rows rows
+/// - /B2/monitor/port port
+/// - /B2/monitor/interval value unit
+/// - /B2/sweep/moderatorThickness thicknesses
+/// - /B2/sweep/targetMaterial materials
+/// - /B2/sweep/processes processes
+/// - /B2/sweep/beamOn nEvents
+/// - /B2/beam/profile radial|disc|gauss|map
+/// - /B2/beam/radius value unit
+/// - /B2/beam/sigma value unit
+/// - /B2/beam/map file
+/// - /B2/beam/sampling pseudo|stratified|sobol
+/// - /B2/beam/strata strata
+///
+/// The commands act on the master and are not broadcast to workers.
+
+class RunMessenger: public G4UImessenger
+{
+  public:
+    RunMessenger();
+    ~RunMessenger() override;
+
+    void SetNewValue(G4UIcommand*, G4String) override;
+
+  private:
+    G4UIdirectory*             fRunDirectory = nullptr;
+
+    G4UIcmdWithADouble*        fTargetRelErrorCmd = nullptr;
+    G4UIcmdWithAString*        fStopTalliesCmd = nullptr;
+    G4UIcmdWithADoubleAndUnit* fMaxWallTimeCmd = nullptr;
+    G4UIcmdWithADoubleAndUnit* fPrintIntervalCmd = nullptr;
+    G4UIcmdWithAnInteger*      fFlushIntervalCmd = nullptr;
+    G4UIcmdWithAString*        fSeedModeCmd = nullptr;
+    G4UIcmdWithAnInteger*      fMasterSeedCmd = nullptr;
+    G4UIcmdWithAnInteger*      fReplayEventCmd = nullptr;
+    G4UIcmdWithAnInteger*      fBeamOnCmd = nullptr;
+    G4UIcmdWithAnInteger*      fPrimariesCmd = nullptr;
+    G4UIcmdWithAString*        fPinningCmd = nullptr;
+    G4UIcmdWithAString*        fPhysicsTableCacheCmd = nullptr;
+    G4UIcmdWithAString*        fEarlyTerminationCmd = nullptr;
+
+    G4UIdirectory*             fCheckpointDirectory = nullptr;
+
+    G4UIcmdWithAString*        fCheckpointDirCmd = nullptr;
+    G4UIcmdWithADoubleAndUnit* fCheckpointIntervalCmd = nullptr;
+    G4UIcmdWithAnInteger*      fCheckpointBeamOnCmd = nullptr;
+
+    G4UIdirectory*             fProfileDirectory = nullptr;
+
+    G4UIcmdWithABool*          fProfileEnableCmd = nullptr;
+    G4UIcmdWithAnInteger*      fProfileRowsCmd = nullptr;
+
+    G4UIdirectory*             fMonitorDirectory = nullptr;
+
+    G4UIcmdWithAnInteger*      fMonitorPortCmd = nullptr;
+    G4UIcmdWithADoubleAndUnit* fMonitorIntervalCmd = nullptr;
+
+    G4UIdirectory*             fSweepDirectory = nullptr;
+
+    G4UIcmdWithAString*        fSweepThicknessCmd = nullptr;
+    G4UIcmdWithAString*        fSweepMaterialCmd = nullptr;
+    G4UIcmdWithAnInteger*      fSweepProcessesCmd = nullptr;
+    G4UIcmdWithAnInteger*      fSweepBeamOnCmd = nullptr;
+
+    G4UIdirectory*             fBeamDirectory = nullptr;
+
+    G4UIcmdWithAString*        fBeamProfileCmd = nullptr;
+    G4UIcmdWithADoubleAndUnit* fBeamRadiusCmd = nullptr;
+    G4UIcmdWithADoubleAndUnit* fBeamSigmaCmd = nullptr;
+    G4UIcmdWithAString*        fBeamMapCmd = nullptr;
+    G4UIcmdWithAString*        fBeamSamplingCmd = nullptr;
+    G4UIcmdWithAnInteger*      fBeamStrataCmd = nullptr;
+};
+
+}
+
+#endif
@@ -0,0 +1,152 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/RunStatistics.hh
+/// \brief Definition of the B2::RunStatistics class
+
+#ifndef B2RunStatistics_h
+#define B2RunStatistics_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace B2
+{
+
+/// Throughput, load balance and event latency of the threads of a run.
+///
+/// Every thread counts in thread-local counters the events, tracks, steps
+/// and hits it processes, the time it spends inside events and its CPU
+/// time, and records when it finished its last event. Counts are folded
+/// into shared atomics every few hundred events, from which a progress
+/// line is printed every fPrintInterval seconds. At the end of the run the
+/// master prints for each thread its events, events/s, busy and idle time
+/// and the CPU it ended on, the end-of-run tail (time between the first and
+/// the last worker running out of events) and percentiles of the event
+/// processing time taken from log2-binned histograms, and the events ended
+/// early by B2::EventTermination with the tracks they skipped. Write() saves the
+/// same summary, with the geometry and thread set-up, as JSON.
+
+class RunStatistics
+{
+  public:
+    static RunStatistics* Instance();
+
+    // Called from every thread's run action
+    void BeginOfRun();
+    void EndOfRun();
+
+    // Thread processing the event
+    void BeginOfEvent();
+    void EndOfTrack(G4int nSteps);
+    void EndOfEvent(G4long nHits);
+    void TerminatedEvent(G4long skippedTracks);
+
+    // Master: write the summary of the last run
+    void Write(const G4String& fileName, G4int runID) const;
+
+    void SetPrintInterval(G4double seconds) { fPrintInterval = seconds; }
+
+  private:
+    RunStatistics() = default;
+
+    using Clock = std::chrono::steady_clock;
+
+    // Event time bins: [2^(i-1), 2^i) microseconds, bin 0 below 1 us
+    static constexpr std::size_t kLatencyBins = 40;
+    // Events per thread between updates of the shared progress counters
+    static constexpr G4long kProgressBatch = 256;
+
+    struct Counts
+    {
+      G4long events = 0;
+      G4long tracks = 0;
+      G4long steps = 0;
+      G4long hits = 0;
+      G4long terminated = 0;  // events ended by B2::EventTermination
+      G4long skipped = 0;     // tracks these events did not follow
+    };
+
+    struct ThreadCounters
+    {
+      Counts counts;
+      Counts reported;  // already added to the progress counters
+      Clock::time_point start;
+      Clock::time_point eventStart;
+      Clock::time_point lastEventEnd;
+      G4double cpuStart = 0.;
+      G4double busy = 0.;  // seconds inside events
+      G4double maxEvent = 0.;
+      std::vector<G4long> latency = std::vector<G4long>(kLatencyBins, 0);
+    };
+
+    struct ThreadRecord
+    {
+      G4int threadId = 0;
+      G4int cpu = -1;
+      Counts counts;
+      G4double seconds = 0.;
+      G4double cpuTime = 0.;
+      G4double busy = 0.;
+      G4double finish = -1.;  // last event end since the master's start
+    };
+
+    ThreadCounters* GetThreadCounters();
+    void ReportProgress(ThreadCounters* counters);
+    void Print() const;
+    G4double GetLatencyPercentile(G4double fraction) const;
+    Counts GetTotals() const;
+    G4double GetIdleFraction() const;
+    G4double GetTail() const;
+
+    // CPU time of the calling thread in seconds, -1 if unavailable
+    static G4double GetThreadCpuTime();
+
+    static G4ThreadLocal ThreadCounters* fgThreadCounters;
+
+    G4Mutex fMutex;
+    Clock::time_point fRunStart;
+    G4double fWallTime = 0.;
+    std::vector<ThreadRecord> fRecords;
+    std::vector<G4long> fLatency;
+    G4double fMaxEventTime = 0.;
+
+    // Progress of the running run
+    G4double fPrintInterval = 60.;  // seconds, 0 disables
+    std::atomic<G4long> fProgressEvents{0};
+    std::atomic<G4long> fProgressSteps{0};
+    std::atomic<G4double> fNextPrint{0.};
+    G4double fLastPrintTime = 0.;
+    G4long fLastPrintEvents = 0;
+};
+
+}
+
+#endif
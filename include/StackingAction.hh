@@ -0,0 +1,58 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/StackingAction.hh
+/// \brief Definition of the B2::StackingAction class
+
+#ifndef B2StackingAction_h
+#define B2StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+
+namespace B2
+{
+
+/// Stacking action class
+///
+/// In the NeutronsFirst and FirstEntry modes of B2::EventTermination,
+/// neutrons go to the urgent stack and every other track to the waiting
+/// stack, so each stage follows the neutrons before the particles that may
+/// still produce more of them.
+/// Once the event is terminated its new tracks are killed. Otherwise all
+/// tracks are urgent, as without a stacking action.
+
+class StackingAction : public G4UserStackingAction
+{
+  public:
+    StackingAction() = default;
+    ~StackingAction() override = default;
+
+    G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track* ) override;
+};
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/StartupProfiler.hh
+/// \brief Definition of the B2::StartupProfiler class
+
+#ifndef B2StartupProfiler_h
+#define B2StartupProfiler_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+#include "G4VStateDependent.hh"
+
+#include <chrono>
+#include <vector>
+
+namespace B2
+{
+
+/// Wall time of the startup phases.
+///
+/// The master follows its application states: every Init period opened
+/// by /run/initialize or by the initialisation of a run is timed, and the
+/// phases started and stopped inside it (materials, geometry, overlap
+/// check) are subtracted to leave the physics list share. The table of
+/// /run/initialize is printed as soon as it ends. Geant4 only builds the
+/// physics tables when the first run starts, and the workers initialise
+/// after that, so these two lines are printed at the end of the first run.
+/// Worker initialisation runs from WorkerInitialize() to the first
+/// BeginOfRunAction of the thread; the slowest worker is reported.
+///
+/// The instance registers with the master G4StateManager, which deletes it.
+
+class StartupProfiler : public G4VStateDependent
+{
+  public:
+    static StartupProfiler* Instance();
+
+    // Master: phases of the current Init period
+    void StartPhase(const G4String& name);
+    void StopPhase(const G4String& note = "");
+
+    // Workers, from WorkerInitialize() to their first run
+    void BeginWorker();
+    // Called from every thread's run action
+    void BeginOfRun();
+    void EndOfRun();
+
+    G4bool Notify(G4ApplicationState requestedState) override;
+
+  private:
+    StartupProfiler() = default;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Phase
+    {
+      G4String name;
+      G4double seconds = 0.;
+      G4String note;
+    };
+
+    static G4double Seconds(Clock::time_point start);
+    void PrintInitialization(G4double seconds) const;
+
+    static G4ThreadLocal Clock::time_point* fgWorkerStart;
+
+    G4bool fInPeriod = false;
+    Clock::time_point fPeriodStart;
+    Clock::time_point fPhaseStart;
+    std::vector<Phase> fPhases;
+    G4double fPhysicsTables = -1.;
+    G4bool fRunPrinted = false;
+
+    G4Mutex fMutex;
+    G4int fWorkers = 0;
+    G4double fSlowestWorker = 0.;
+};
+
+}
+
+#endif
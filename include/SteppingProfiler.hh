@@ -0,0 +1,124 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/SteppingProfiler.hh
+/// \brief Definition of the B2::SteppingProfiler class
+
+#ifndef B2SteppingProfiler_h
+#define B2SteppingProfiler_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+class G4LogicalVolume;
+class G4ParticleDefinition;
+class G4Step;
+class G4VProcess;
+
+namespace B2
+{
+
+/// Step count and CPU time by (logical volume, particle, process).
+///
+/// B2::SteppingAction feeds it the steps of every thread while it is
+/// enabled and returns at once otherwise. Each step is charged the
+/// steady-clock time since the previous step or track start of the thread,
+/// which includes the secondaries' bookkeeping done for that step.
+/// Thread-local tables keyed by pointers are merged by name at the end of
+/// the run, when the master prints the entries with the largest time and
+/// writes the full table as CSV.
+
+class SteppingProfiler
+{
+  public:
+    static SteppingProfiler* Instance();
+
+    void SetEnabled(G4bool enabled) { fEnabled = enabled; }
+    G4bool IsEnabled() const { return fEnabled; }
+    void SetPrintRows(G4int rows) { fPrintRows = rows; }
+
+    // Called from every thread's run action
+    void BeginOfRun();
+    void EndOfRun();
+
+    // Thread processing the event
+    void StartTrack();
+    void Step(const G4Step* step);
+
+    // Master: write the merged table of the last run
+    void Write(const G4String& fileName) const;
+
+  private:
+    SteppingProfiler() = default;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+      G4long steps = 0;
+      G4double seconds = 0.;
+    };
+
+    using Key = std::tuple<const G4LogicalVolume*, const G4ParticleDefinition*,
+                           const G4VProcess*>;
+
+    struct KeyHash
+    {
+      std::size_t operator()(const Key& key) const;
+    };
+
+    struct ThreadProfile
+    {
+      std::unordered_map<Key, Entry, KeyHash> entries;
+      Clock::time_point last;
+      // Consecutive steps of a track mostly share their key
+      Key lastKey{nullptr, nullptr, nullptr};
+      Entry* lastEntry = nullptr;
+    };
+
+    using NameKey = std::tuple<G4String, G4String, G4String>;
+
+    ThreadProfile* GetThreadProfile();
+    void Print() const;
+
+    static G4ThreadLocal ThreadProfile* fgThreadProfile;
+
+    std::atomic<G4bool> fEnabled{false};  // set by the master, read by the workers
+    G4int fPrintRows = 20;
+
+    G4Mutex fMutex;
+    std::map<NameKey, Entry> fMerged;
+};
+
+}
+
+#endif
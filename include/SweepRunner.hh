@@ -0,0 +1,92 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/SweepRunner.hh
+/// \brief Definition of the B2::SweepRunner class
+
+#ifndef B2SweepRunner_h
+#define B2SweepRunner_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+/// Parameter sweep in child processes forked after initialisation.
+///
+/// /B2/sweep/beamOn N builds the physics tables once in the process that
+/// ran /run/initialize (a run of 0 events), then forks one child per sweep
+/// point, at most /B2/sweep/processes at a time. The points are all the
+/// combinations of the moderator thicknesses and target materials given.
+/// Each child shares the tables of its parent copy-on-write, applies its
+/// point with /B2/det/setModeratorThickness and /B2/det/setTargetMaterial,
+/// which rebuilds its geometry, and runs /B2/run/beamOn N. Its outputs
+/// take the point label in RUN_ID (Run0_<RUN_ID>_20mm_LiF.csv...) and its
+/// console goes to output_<RUN_ID>.log. The parent then prints the wall
+/// time, throughput and peak RSS of each point and the aggregate.
+///
+/// A forked child only keeps the thread that called fork(), so the sweep
+/// needs the serial run manager (--run-manager serial) and no monitor.
+/// Every child starts from the random engine state of the parent, as
+/// separate processes started with the same seed would.
+
+class SweepRunner
+{
+  public:
+    static SweepRunner* Instance();
+
+    // Space separated lists, thicknesses in mm; an empty list keeps the
+    // current setting
+    void SetModeratorThicknesses(const G4String& thicknesses);
+    void SetTargetMaterials(const G4String& materials);
+    // Concurrent children, 0 for the available cores
+    void SetProcesses(G4int processes) { fProcesses = processes; }
+
+    // Master: runs nEvents at every point
+    void BeamOn(G4int nEvents);
+
+  private:
+    SweepRunner() = default;
+
+    struct Point
+    {
+      G4String label;
+      std::vector<G4String> commands;
+    };
+
+    std::vector<Point> GetPoints() const;
+    [[noreturn]] void RunPoint(const Point& point, G4int nEvents) const;
+
+    std::vector<G4double> fThicknesses;
+    std::vector<G4String> fMaterials;
+    G4int fProcesses = 0;
+};
+
+}
+
+#endif
@@ -0,0 +1,150 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/TallyManager.hh
+/// \brief Definition of the B2::TallyManager class
+
+#ifndef B2TallyManager_h
+#define B2TallyManager_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+namespace B2
+{
+
+/// Per-history tally accumulation shared by all worker threads.
+///
+/// Each tally accumulates the sum and the sum of squares of its score per
+/// history (one primary proton). Workers score into thread-local buffers
+/// which are folded into the merged totals every fFlushInterval histories.
+/// On each flush the relative error R = sqrt(sum2/sum^2 - 1/N) and the
+/// figure of merit FOM = 1/(R^2 T) are printed periodically, and the run is
+/// flagged to stop once the selected tallies reach the target relative
+/// error or the wall-clock budget is exhausted.
+
+class TallyManager
+{
+  public:
+    static TallyManager* Instance();
+
+    // Tally definition; must happen before the first run
+    G4int AddTally(const G4String& name);
+    G4int GetTallyId(const G4String& name) const;
+    std::size_t GetNumberOfTallies() const { return fNames.size(); }
+
+    // Called from every thread's run action
+    void BeginOfRun();
+    void EndOfRun();
+
+    // Master: write the merged sums, which shards can be combined from
+    void Write(const G4String& fileName) const;
+
+    // Worker side: score into the current history, then close it
+    void Score(G4int id, G4double value);
+    void EndOfHistory();
+
+    // Stop criteria
+    void SetTargetRelativeError(G4double value) { fTargetRelError = value; }
+    void SetStopTallies(const G4String& names);
+    void SetMaxWallTime(G4double seconds) { fMaxWallTime = seconds; }
+    void SetPrintInterval(G4double seconds) { fPrintInterval = seconds; }
+    void SetFlushInterval(G4int histories) { fFlushInterval = histories; }
+    G4bool IsStopRequested() const { return fStopRequested.load(); }
+    void RequestStop() { fStopRequested = true; }
+
+    // Merged results
+    G4double GetMean(G4int id) const;
+    G4double GetRelativeError(G4int id) const;
+    G4double GetFigureOfMerit(G4int id) const;
+    G4double GetElapsedTime() const;
+    const G4String& GetTallyName(G4int id) const { return fNames[id]; }
+
+    // Consistent copy of the merged results, safe while the run goes on
+    void GetResults(std::vector<G4double>& mean, std::vector<G4double>& relError,
+                    G4long& nHistories) const;
+
+    // Checkpointing: totals scored by the calling thread in this run, and
+    // totals of earlier run segments which the next run starts from
+    void GetThreadTotals(std::vector<G4double>& sum, std::vector<G4double>& sum2,
+                         G4long& nHistories);
+    void SetBaseline(const std::vector<G4double>& sum, const std::vector<G4double>& sum2,
+                     G4long nHistories, G4double elapsed);
+
+  private:
+    TallyManager() = default;
+
+    struct ThreadTallies
+    {
+      std::vector<G4double> history;
+      std::vector<G4double> sum;
+      std::vector<G4double> sum2;
+      G4long nHistories = 0;
+      // cumulative over the run, not reset by Flush()
+      std::vector<G4double> total;
+      std::vector<G4double> total2;
+      G4long nTotal = 0;
+    };
+
+    ThreadTallies* GetThreadTallies();
+    void Flush(ThreadTallies* tallies);
+    void Print(const G4String& header) const;
+    void CheckStopCriteria();
+
+    static G4ThreadLocal ThreadTallies* fgThreadTallies;
+
+    mutable G4Mutex fMutex;
+
+    std::vector<G4String> fNames;
+    std::vector<G4double> fSum;
+    std::vector<G4double> fSum2;
+    G4long fNHistories = 0;
+
+    std::vector<G4double> fBaselineSum;
+    std::vector<G4double> fBaselineSum2;
+    G4long fBaselineHistories = 0;
+    G4double fBaselineTime = 0.;  // elapsed seconds of earlier segments
+    G4double fTimeOffset = 0.;
+
+    std::vector<G4String> fStopNames;  // resolved into fStopIds at run start
+    std::vector<G4int> fStopIds;
+    G4double fTargetRelError = 0.;  // 0 disables the precision criterion
+    G4double fMaxWallTime = 0.;     // seconds, 0 disables the time budget
+    G4double fPrintInterval = 60.;  // seconds
+    G4int fFlushInterval = 1000;    // histories per thread between merges
+
+    std::chrono::steady_clock::time_point fStartTime;
+    G4double fLastPrint = 0.;
+    std::atomic<G4bool> fStopRequested{false};
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/ThreadPlacement.hh
+/// \brief Definition of the B2::ThreadPlacement class
+
+#ifndef B2ThreadPlacement_h
+#define B2ThreadPlacement_h 1
+
+#include "globals.hh"
+#include "G4Threading.hh"
+
+#include <vector>
+
+namespace B2
+{
+
+/// CPU topology of the process and placement of the worker threads.
+///
+/// The usable cores are those of the process affinity mask at start-up,
+/// further limited by a cgroup CPU quota, so that the default number of
+/// threads matches what a batch system or container grants. Workers can be
+/// pinned to one CPU each, either in the order of the affinity mask
+/// (Compact) or alternating between NUMA nodes (Numa), so that the memory
+/// a worker first touches stays on its own socket. On other systems than
+/// Linux no pinning takes place.
+
+class ThreadPlacement
+{
+  public:
+    enum class Mode { None, Compact, Numa };
+
+    static ThreadPlacement* Instance();
+
+    // Cores available to the process, at least 1
+    G4int GetNumberOfAvailableCores() const;
+
+    void SetMode(Mode mode) { fMode = mode; }
+    Mode GetMode() const { return fMode; }
+
+    // Worker: pin the calling thread according to the mode and its thread id
+    void PinCurrentThread();
+
+    // CPU the calling thread currently runs on, -1 if unknown
+    static G4int GetCurrentCpu();
+
+  private:
+    ThreadPlacement();
+
+    const std::vector<G4int>& GetPlacementOrder();
+
+    Mode fMode = Mode::None;
+    std::vector<G4int> fAllowedCpus;
+    std::vector<G4int> fCpuNodes;  // NUMA node of each allowed CPU
+    std::vector<G4int> fOrder;     // CPU of worker i % size, per mode
+    Mode fOrderMode = Mode::None;
+    G4Mutex fMutex;
+};
+
+}
+
+#endif
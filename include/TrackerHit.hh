@@ -35,7 +35,6 @@
 #include "G4ThreeVector.hh"
 #include "G4VHit.hh"
 #include "tls.hh"
-#include <map>
 
 namespace B2 {
 
@@ -44,9 +43,11 @@ namespace B2 {
 /// It defines data members to store the trackID, chamberNb, energy deposit,
 /// and position of charged particles in a selected volume:
 /// - fTrackID, fChamberNB, fEdep, fPos
-
-static std::map<G4int, G4String> fChamberNbToName = {{0, "Flange"}, {1, "Moderator"}, {2, "Panel"}, {3, "BertholdGas"}, {4, "Scorer1"}, {5, "Scorer2"}, {6, "Scorer3"}};
-static std::map<G4String, G4int> fChamberNameToNb = {{"Flange", 0}, {"Moderator", 1}, {"Panel", 2}, {"BertholdGas", 3}, {"Scorer1", 4}, {"Scorer2", 5}, {"Scorer3", 6}};
+/// The chamber number is the detector number of B2::DetectorRegistry.
+/// A hit covers one step or, in the track hit mode of B2::TrackerSD, all
+/// steps of a track in the volume: fE is the energy at entry, fExitE after
+/// the last step, fTrackLength and fNSteps their length and number.
+/// fPrimary is the index of the primary proton the track descends from.
 
 class TrackerHit : public G4VHit {
   public:
@@ -72,16 +73,23 @@ class TrackerHit : public G4VHit {
     void SetEdep(G4double de) { fEdep = de; };
     void SetE(G4double e) { fE = e; };
     void SetPos(G4ThreeVector xyz) { fPos = xyz; };
+    void SetExitE(G4double e) { fExitE = e; };
+    void SetTrackLength(G4double length) { fTrackLength = length; };
+    void SetNSteps(G4int n) { fNSteps = n; };
+    void SetPrimary(G4int primary) { fPrimary = primary; };
 
     // Get methods
     G4String GetParticleName() const { return fParticleName; };
     G4int GetTrackID() const { return fTrackID; };
     G4int GetChamberNb() const { return fChamberNb; };
-    G4String GetChamberName() const { return fChamberNbToName.at(fChamberNb); };
+    G4String GetChamberName() const;
     G4double GetEdep() const { return fEdep; };
     G4double GetE() const { return fE; };
     G4ThreeVector GetPos() const { return fPos; };
-    static G4int NameToNb(G4String name) { return fChamberNameToNb.at(name); };
+    G4double GetExitE() const { return fExitE; };
+    G4double GetTrackLength() const { return fTrackLength; };
+    G4int GetNSteps() const { return fNSteps; };
+    G4int GetPrimary() const { return fPrimary; };
 
   private:
     G4String fParticleName = "";
@@ -90,6 +98,10 @@ class TrackerHit : public G4VHit {
     G4double fEdep = 0.;
     G4double fE = 0.;
     G4ThreeVector fPos;
+    G4double fExitE = 0.;
+    G4double fTrackLength = 0.;
+    G4int fNSteps = 0;
+    G4int fPrimary = 0;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -34,6 +34,8 @@
 
 #include "TrackerHit.hh"
 
+#include <atomic>
+#include <unordered_map>
 #include <vector>
 
 class G4Step;
@@ -45,16 +47,30 @@ namespace B2
 /// Tracker sensitive detector class
 ///
 /// The hits are accounted in hits in ProcessHits() function which is called
-/// by Geant4 kernel at each step. A hit is created with each step with non zero
-/// energy deposit.
+/// by Geant4 kernel at each step. Each detector of B2::DetectorRegistry has
+/// its own instance, which tags its hits with the detector number. In the
+/// Step hit mode a hit is created with each step of a neutron, at the end
+/// of the step. In the Track mode a track keeps one hit per volume, found
+/// through a per-event track id table and updated in place: entry energy
+/// and position (the pre-step point of its first step in the volume), exit
+/// energy, total energy deposit, path length and number of steps. While
+/// B2::EventTermination is active it reports the first neutron each primary
+/// sends into the detector.
 
 class TrackerSD : public G4VSensitiveDetector
 {
   public:
+    enum class HitMode { Step, Track };
+
     TrackerSD(const G4String& name,
-                const G4String& hitsCollectionName);
+                const G4String& hitsCollectionName,
+                G4int detectorNumber);
     ~TrackerSD() override = default;
 
+    // Applies from the next event on, in all threads
+    static void SetHitMode(HitMode mode) { fgHitMode = mode; }
+    static HitMode GetHitMode() { return fgHitMode; }
+
     // methods from base class
     void   Initialize(G4HCofThisEvent* hitCollection) override;
     G4bool ProcessHits(G4Step* step, G4TouchableHistory* history) override;
@@ -62,6 +78,19 @@ class TrackerSD : public G4VSensitiveDetector
 
   private:
     TrackerHitsCollection* fHitsCollection = nullptr;
+    G4int fDetectorNumber = -1;
+    G4int fHitsCollectionId = -1;
+
+    // Track mode: hit of each track in this event
+    HitMode fHitMode = HitMode::Step;
+    std::unordered_map<G4int, TrackerHit*> fTrackHits;
+    G4int fLastTrackID = -1;
+    TrackerHit* fLastHit = nullptr;
+
+    // Primaries of this event that already sent a neutron in
+    std::vector<G4bool> fEntered;
+
+    static std::atomic<HitMode> fgHitMode;
 };
 
 }
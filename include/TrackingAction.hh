@@ -0,0 +1,57 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/TrackingAction.hh
+/// \brief Definition of the B2::TrackingAction class
+
+#ifndef B2TrackingAction_h
+#define B2TrackingAction_h 1
+
+#include "G4UserTrackingAction.hh"
+
+namespace B2
+{
+
+/// Tracking action class
+///
+/// Counts the tracks and steps of the run for B2::RunStatistics; the step
+/// count is taken once per track so no stepping action is needed. When
+/// B2::SteppingProfiler is enabled it also restarts its clock per track.
+/// Every track is registered with B2::PrimaryIndex before its first step.
+
+class TrackingAction : public G4UserTrackingAction
+{
+  public:
+    TrackingAction() = default;
+    ~TrackingAction() override = default;
+
+    void PreUserTrackingAction(const G4Track* ) override;
+    void PostUserTrackingAction(const G4Track* ) override;
+};
+
+}
+
+#endif
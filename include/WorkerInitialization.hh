@@ -0,0 +1,64 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/WorkerInitialization.hh
+/// \brief Definition of the B2::WorkerInitialization class
+
+#ifndef B2WorkerInitialization_h
+#define B2WorkerInitialization_h 1
+
+#include "G4UserWorkerInitialization.hh"
+#include "globals.hh"
+
+namespace B2
+{
+
+/// Worker initialization class.
+///
+/// Pins each worker thread through B2::ThreadPlacement as soon as it
+/// starts, before it builds its geometry and physics tables, so that these
+/// are allocated on the NUMA node the worker runs on. With --rng xoshiro it
+/// also replaces the engine Geant4 cloned from the master by a
+/// B2::XoshiroEngine; the master keeps MixMax to draw the event seeds.
+/// The start of the worker initialisation is recorded by
+/// B2::StartupProfiler.
+
+class WorkerInitialization : public G4UserWorkerInitialization
+{
+  public:
+    explicit WorkerInitialization(G4bool xoshiroEngine = false)
+      : fXoshiroEngine(xoshiroEngine) {}
+    ~WorkerInitialization() override = default;
+
+    void WorkerInitialize() const override;
+
+  private:
+    G4bool fXoshiroEngine = false;
+};
+
+}
+
+#endif
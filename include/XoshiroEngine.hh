@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/include/XoshiroEngine.hh
+/// \brief Definition of the B2::XoshiroEngine class
+
+#ifndef B2XoshiroEngine_h
+#define B2XoshiroEngine_h 1
+
+#include "CLHEP/Random/RandomEngine.h"
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace B2
+{
+
+/// Batched xoshiro256+ random engine.
+///
+/// Four independent xoshiro256+ generators run side by side and refill a
+/// buffer of 256 doubles at a time. Their state is stored word by word
+/// (structure of arrays), so the refill loop has no dependency between
+/// lanes and is vectorised by the compiler; flat() then only reads the
+/// buffer. The doubles keep the upper 52 bits of each output and lie in
+/// the open interval (0,1).
+///
+/// setSeed()/setSeeds() hash the seeds with splitmix64 into the 16 state
+/// words, so the per-event reseeding of Geant4 and of B2::EventSeeder
+/// costs a few nanoseconds. Different seeds give independent streams with
+/// overwhelming probability, but not the guaranteed non-overlapping
+/// streams of MixMax. put()/get() save the state that produced the current
+/// buffer and the position in it, so a restored engine continues exactly.
+///
+/// Selected with --rng xoshiro on the command line.
+
+class XoshiroEngine : public CLHEP::HepRandomEngine
+{
+  public:
+    XoshiroEngine();
+    explicit XoshiroEngine(long seed);
+    ~XoshiroEngine() override = default;
+
+    double flat() override
+    {
+      if (fIndex == kBufferSize) Refill();
+      return fBuffer[fIndex++];
+    }
+    void flatArray(const int size, double* vect) override;
+
+    void setSeed(long seed, int) override;
+    void setSeeds(const long* seeds, int seedNum) override;
+
+    void saveStatus(const char filename[] = "Config.conf") const override;
+    void restoreStatus(const char filename[] = "Config.conf") override;
+    void showStatus() const override;
+
+    std::string name() const override { return engineName(); }
+    static std::string engineName() { return "XoshiroEngine"; }
+
+    std::ostream& put(std::ostream& os) const override;
+    std::istream& get(std::istream& is) override;
+    std::istream& getState(std::istream& is) override;
+
+    std::vector<unsigned long> put() const override;
+    bool get(const std::vector<unsigned long>& v) override;
+    bool getState(const std::vector<unsigned long>& v) override;
+
+    static constexpr int kLanes = 4;
+    static constexpr int kBufferSize = 256;
+    static constexpr int kMaxSeeds = 16;
+
+  private:
+    void Refill();
+    void SetState(const std::uint64_t* words, std::size_t nWords);
+
+    // fState[word][lane]; fBlockState produced the current buffer
+    std::uint64_t fState[4][kLanes];
+    std::uint64_t fBlockState[4][kLanes];
+    int fIndex = kBufferSize;
+    long fSeeds[kMaxSeeds + 1] = {};  // returned by getSeeds(), ends in 0
+    alignas(64) double fBuffer[kBufferSize];
+};
+
+}
+
+#endif
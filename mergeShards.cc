@@ -0,0 +1,314 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file mergeShards.cc
+/// \brief Merges the CSV output of several exampleB2b --shard processes
+//
+// Usage: mergeShards <out-prefix> <shard-prefix>...
+//
+// A shard prefix is the file base of one shard, e.g. Run0_shard2of4.
+// Histograms are summed bin by bin, using the last checkpoint segment of
+// each shard as it already contains the earlier ones. Tallies are pooled
+// from their per-history sums so the relative error is recomputed over all
+// histories. Ntuples of all segments and threads are concatenated with an
+// extra Shard column.
+
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+struct ShardFiles
+{
+  // Histogram name -> (segment, path) of the latest segment
+  std::map<std::string, std::pair<int, std::string>> h1;
+  std::pair<int, std::string> tallies{-1, ""};
+  // Ntuple name -> files of all segments and threads
+  std::map<std::string, std::vector<std::string>> ntuples;
+};
+
+struct Tally
+{
+  long long histories = 0;
+  double sum = 0.;
+  double sum2 = 0.;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ShardFiles FindFiles(const std::string& prefix)
+{
+  namespace fs = std::filesystem;
+
+  fs::path path(prefix);
+  fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+  std::string base = path.filename().string();
+
+  static const std::regex pattern(
+    R"(^(?:_seg(\d+))?_(?:h1_(.+)|(tallies)|nt_(.+?)(?:_t\d+)?)\.csv$)");
+
+  ShardFiles files;
+  for (const auto& entry : fs::directory_iterator(dir)) {
+    std::string name = entry.path().filename().string();
+    if (name.compare(0, base.size(), base) != 0) continue;
+
+    std::smatch match;
+    std::string rest = name.substr(base.size());
+    if ( ! std::regex_match(rest, match, pattern)) continue;
+
+    int segment = match[1].matched ? std::stoi(match[1]) : 0;
+    std::string file = entry.path().string();
+    if (match[2].matched) {
+      auto& latest = files.h1[match[2]];
+      if (latest.second.empty() || segment > latest.first) latest = {segment, file};
+    }
+    else if (match[3].matched) {
+      if (segment > files.tallies.first) files.tallies = {segment, file};
+    }
+    else {
+      files.ntuples[match[4]].push_back(file);
+    }
+  }
+  return files;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Splits a CSV file into its '#' header lines and the remaining lines
+bool ReadCsv(const std::string& file, std::vector<std::string>& header,
+             std::vector<std::string>& lines)
+{
+  std::ifstream in(file);
+  if ( ! in) {
+    std::cerr << "Cannot read " << file << std::endl;
+    return false;
+  }
+  std::string line;
+  while (std::getline(in, line)) {
+    if ( ! line.empty() && line[0] == '#') header.push_back(line);
+    else if ( ! line.empty()) lines.push_back(line);
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<double> SplitNumbers(const std::string& line)
+{
+  std::vector<double> values;
+  std::stringstream stream(line);
+  std::string field;
+  while (std::getline(stream, field, ',')) values.push_back(std::stod(field));
+  return values;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool MergeHistogram(const std::string& name, const std::vector<std::string>& inputs,
+                    const std::string& output)
+{
+  std::vector<std::string> header, columns;
+  std::vector<std::vector<double>> bins;
+
+  for (const auto& input : inputs) {
+    std::vector<std::string> fileHeader, lines;
+    if ( ! ReadCsv(input, fileHeader, lines) || lines.empty()) return false;
+
+    if (bins.empty()) {
+      header = fileHeader;
+      columns.push_back(lines[0]);
+      for (std::size_t i = 1; i < lines.size(); ++i) bins.push_back(SplitNumbers(lines[i]));
+      continue;
+    }
+    if (fileHeader != header || lines[0] != columns[0] || lines.size() != bins.size() + 1) {
+      std::cerr << "Histogram " << name << " in " << input
+                << " does not match the binning of " << inputs[0] << std::endl;
+      return false;
+    }
+    for (std::size_t i = 1; i < lines.size(); ++i) {
+      std::vector<double> values = SplitNumbers(lines[i]);
+      if (values.size() != bins[i - 1].size()) return false;
+      for (std::size_t j = 0; j < values.size(); ++j) bins[i - 1][j] += values[j];
+    }
+  }
+
+  std::ofstream out(output);
+  out << std::setprecision(std::numeric_limits<double>::max_digits10);
+  for (const auto& line : header) out << line << "\n";
+  out << columns[0] << "\n";
+  for (const auto& bin : bins) {
+    for (std::size_t j = 0; j < bin.size(); ++j) out << (j ? "," : "") << bin[j];
+    out << "\n";
+  }
+  return static_cast<bool>(out);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool MergeTallies(const std::vector<std::string>& inputs, const std::string& output)
+{
+  std::vector<std::string> names;
+  std::map<std::string, Tally> tallies;
+  double elapsed = 0.;
+
+  for (const auto& input : inputs) {
+    std::vector<std::string> header, lines;
+    if ( ! ReadCsv(input, header, lines) || lines.empty()) return false;
+
+    for (const auto& line : header) {
+      if (line.compare(0, 9, "#elapsed ") == 0) elapsed += std::stod(line.substr(9));
+      if (line.compare(0, 12, "#elapsedSum ") == 0) elapsed += std::stod(line.substr(12));
+    }
+    // The first line holds the column names
+    for (std::size_t i = 1; i < lines.size(); ++i) {
+      std::stringstream stream(lines[i]);
+      std::string name, histories, sum, sum2;
+      std::getline(stream, name, ',');
+      std::getline(stream, histories, ',');
+      std::getline(stream, sum, ',');
+      std::getline(stream, sum2, ',');
+
+      if (tallies.find(name) == tallies.end()) names.push_back(name);
+      Tally& tally = tallies[name];
+      tally.histories += std::stoll(histories);
+      tally.sum += std::stod(sum);
+      tally.sum2 += std::stod(sum2);
+    }
+  }
+
+  std::ofstream out(output);
+  out << std::setprecision(std::numeric_limits<double>::max_digits10);
+  // Wall time of the shards added up; the shards ran side by side, so the
+  // merged run has no single elapsed time
+  out << "#class B2::TallyManager\n"
+      << "#elapsedSum " << elapsed << "\n"
+      << "name,histories,sum,sum2,mean,relError\n";
+  for (const auto& name : names) {
+    const Tally& tally = tallies[name];
+    double mean = tally.histories > 0 ? tally.sum / tally.histories : 0.;
+    double relError = -1.;
+    if (tally.histories > 0 && tally.sum > 0.) {
+      double var = tally.sum2 / (tally.sum * tally.sum) - 1. / tally.histories;
+      relError = var > 0. ? std::sqrt(var) : 0.;
+    }
+    out << name << "," << tally.histories << "," << tally.sum << "," << tally.sum2 << ","
+        << mean << "," << relError << "\n";
+  }
+  return static_cast<bool>(out);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool MergeNtuple(const std::string& name,
+                 const std::vector<std::pair<int, std::string>>& inputs,
+                 const std::string& output)
+{
+  std::ofstream out(output);
+  std::vector<std::string> header;
+
+  for (const auto& [shard, input] : inputs) {
+    std::vector<std::string> fileHeader, lines;
+    if ( ! ReadCsv(input, fileHeader, lines)) return false;
+
+    if (header.empty()) {
+      header = fileHeader;
+      // Append the Shard column after the last column declaration
+      std::size_t last = header.size();
+      for (std::size_t i = 0; i < header.size(); ++i) {
+        if (header[i].compare(0, 8, "#column ") == 0) last = i + 1;
+      }
+      for (std::size_t i = 0; i < header.size(); ++i) {
+        out << header[i] << "\n";
+        if (i + 1 == last) out << "#column int Shard\n";
+      }
+    }
+    else if (fileHeader != header) {
+      std::cerr << "Ntuple " << name << " in " << input
+                << " does not match the columns of " << inputs[0].second << std::endl;
+      return false;
+    }
+    for (const auto& line : lines) out << line << "," << shard << "\n";
+  }
+  return static_cast<bool>(out);
+}
+
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  if (argc < 3) {
+    std::cerr << "Usage: " << argv[0] << " <out-prefix> <shard-prefix>..." << std::endl;
+    return 1;
+  }
+  std::string outPrefix = argv[1];
+
+  std::map<std::string, std::vector<std::string>> histograms;
+  std::vector<std::string> tallies;
+  std::map<std::string, std::vector<std::pair<int, std::string>>> ntuples;
+
+  for (int i = 2; i < argc; ++i) {
+    ShardFiles files = FindFiles(argv[i]);
+    if (files.h1.empty() && files.tallies.second.empty() && files.ntuples.empty()) {
+      std::cerr << "No output found for shard " << argv[i] << std::endl;
+      return 1;
+    }
+    for (const auto& [name, file] : files.h1) histograms[name].push_back(file.second);
+    if ( ! files.tallies.second.empty()) tallies.push_back(files.tallies.second);
+    for (const auto& [name, list] : files.ntuples) {
+      for (const auto& file : list) ntuples[name].emplace_back(i - 2, file);
+    }
+  }
+
+  for (const auto& [name, inputs] : histograms) {
+    if (inputs.size() != std::size_t(argc - 2)) {
+      std::cerr << "Histogram " << name << " is missing from some shards" << std::endl;
+      return 1;
+    }
+    if ( ! MergeHistogram(name, inputs, outPrefix + "_h1_" + name + ".csv")) return 1;
+  }
+  if ( ! tallies.empty() && ! MergeTallies(tallies, outPrefix + "_tallies.csv")) return 1;
+  for (const auto& [name, inputs] : ntuples) {
+    if ( ! MergeNtuple(name, inputs, outPrefix + "_nt_" + name + ".csv")) return 1;
+  }
+
+  std::cout << "Merged " << argc - 2 << " shards: " << histograms.size() << " histograms, "
+            << tallies.size() << " tally files, " << ntuples.size() << " ntuples into "
+            << outPrefix << std::endl;
+  return 0;
+}
@@ -0,0 +1,144 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file rebuildBench.cc
+/// \brief Repeated geometry rebuilds: memory and time per cycle
+//
+// Usage: rebuildBench [cycles]
+//
+// Calls B2b::DetectorConstruction::Construct() the given number of times
+// (default 500) in one process, cycling the moderator thickness through
+// 0, 20 and 80 mm as /B2/det/setModeratorThickness does in an in-process
+// sweep. For every block of a tenth of the cycles it prints the mean
+// rebuild time, the resident set size and the sizes of the geometry and
+// material stores. Overlap checks are off, they are cached separately.
+// Exits with an error if the stores grow from one cycle of a thickness to
+// the next, or if the resident set of the last block exceeds that of the
+// second one (the first includes the one-off allocations) by more than
+// 1 MB.
+
+#include "DetectorConstruction.hh"
+
+#include "G4Element.hh"
+#include "G4Isotope.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4Material.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4coutDestination.hh"
+#include "G4ios.hh"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <unistd.h>
+
+namespace
+{
+
+// Construct() reports every volume it places
+class Discard : public G4coutDestination
+{
+  public:
+    G4int ReceiveG4cout(const G4String&) override { return 0; }
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+double ResidentMB()
+{
+  long pages = 0, resident = 0;
+  std::ifstream("/proc/self/statm") >> pages >> resident;
+  return resident * double(sysconf(_SC_PAGESIZE)) / (1024. * 1024.);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::array<std::size_t, 6> StoreSizes()
+{
+  return { G4PhysicalVolumeStore::GetInstance()->size(),
+           G4LogicalVolumeStore::GetInstance()->size(),
+           G4SolidStore::GetInstance()->size(),
+           G4Material::GetNumberOfMaterials(),
+           G4Element::GetNumberOfElements(),
+           G4Isotope::GetNumberOfIsotopes() };
+}
+
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  long cycles = argc > 1 ? std::atol(argv[1]) : 500;
+  if (cycles < 20) {
+    std::fprintf(stderr, "Usage: %s [cycles >= 20]\n", argv[0]);
+    return 1;
+  }
+  const double thicknesses[] = { 0., 20. * mm, 80. * mm };
+  const long block = cycles / 10;
+
+  Discard discard;
+  G4iosSetDestination(&discard);
+
+  B2b::DetectorConstruction detector;
+  detector.SetCheckOverlaps(false);
+
+  std::array<std::array<std::size_t, 6>, 3> sizes{};
+  bool grown = false;
+  double firstRss = 0., lastRss = 0.;
+
+  std::printf("%8s %12s %10s %6s %6s %6s %9s %8s %8s\n", "cycles", "ms/rebuild", "RSS[MB]",
+              "PVs", "LVs", "solids", "materials", "elements", "isotopes");
+  auto start = std::chrono::steady_clock::now();
+  for (long cycle = 0; cycle < cycles; ++cycle) {
+    detector.SetModeratorThickness(thicknesses[cycle % 3]);
+    detector.Construct();
+
+    auto current = StoreSizes();
+    if (cycle >= 3 && current != sizes[cycle % 3]) grown = true;
+    sizes[cycle % 3] = current;
+
+    if ((cycle + 1) % block != 0) continue;
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double rss = ResidentMB();
+    if (cycle + 1 == 2 * block) firstRss = rss;
+    lastRss = rss;
+    std::printf("%8ld %12.3f %10.1f %6zu %6zu %6zu %9zu %8zu %8zu\n", cycle + 1,
+                1.e3 * elapsed.count() / block, rss, current[0], current[1], current[2],
+                current[3], current[4], current[5]);
+    start = std::chrono::steady_clock::now();
+  }
+
+  bool leaked = lastRss - firstRss > 1.;
+  if (grown) std::printf("FAILED: the stores grow with the rebuilds\n");
+  if (leaked) std::printf("FAILED: the resident set grows by %.1f MB\n", lastRss - firstRss);
+  if ( ! grown && ! leaked ) std::printf("Stores and resident set are stable\n");
+  return grown || leaked ? 1 : 0;
+}
@@ -0,0 +1,378 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file reduceNtuples.cc
+/// \brief Reduces the hit ntuples of exampleB2b runs to per-detector summaries
+//
+// Usage: reduceNtuples [options] <run-prefix>...
+//   -j <threads>     files read in parallel (default: hardware threads)
+//   -o <name>        output base name (default: reduced)
+//   --primaries <n>  primaries per run; by default taken from the
+//                    histories of <run-prefix>_tallies.csv
+//   --bins <n> --emin <keV> --emax <keV>
+//                    log-binned spectrum of the per-event energy sum
+//                    (default 100 bins from 1e-5 to 1e4 keV, with the
+//                    edges of a G4AnalysisManager "log" H1)
+//
+// A run prefix is the file base of one configuration, e.g. Run0_20mm. All
+// its ntuple files are read, per thread and per checkpoint segment. Shards
+// are read either as the output of mergeShards, under its out-prefix, or
+// one by one through their own prefix, e.g. Run0_20mm_shard2of4; the
+// _shardXofN files are not picked up by the configuration prefix, so that
+// merged and unmerged copies are never counted twice. Files are streamed,
+// never loaded: the hits of an event are consecutive rows of one file, so
+// an event is complete as soon as the event id changes, and each reader
+// thread only keeps the current event and its own running totals. The
+// output is
+//   <name>_summary.csv  prefix,detector,events,hits,sumE,sumEdep,countsPerUA
+//   <name>_spectra.csv  prefix,detector,bin,eLow,eHigh,events
+// where events counts the histories (primary protons, told apart by the
+// Primary column of events with several primaries) with at least one hit
+// in the detector, sumE the energy column summed over those hits (keV) and
+// countsPerUA the histories per uA s of primary protons (6.25e12 protons).
+
+#include "Histogram.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <regex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr double kProtonsPerMicroAmpereSecond = 6.25e12;
+
+struct Options
+{
+  unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+  std::string output = "reduced";
+  double primaries = 0.;
+  int bins = 100;
+  double eMin = 1.e-5;  // keV
+  double eMax = 1.e4;   // keV
+  std::vector<std::string> prefixes;
+};
+
+struct DetectorSummary
+{
+  long long events = 0;
+  long long hits = 0;
+  double sumE = 0.;
+  double sumEdep = 0.;
+  B2::Histogram1D<B2::LogAxis> spectrum;
+  // Energy sums waiting to be filled into the spectrum as one batch
+  std::vector<double> pending;
+};
+
+// Running totals of one run prefix, per detector
+using RunSummary = std::map<int, DetectorSummary>;
+
+struct Task
+{
+  std::size_t prefix;
+  std::string file;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<std::string> FindNtupleFiles(const std::string& prefix)
+{
+  namespace fs = std::filesystem;
+
+  fs::path path(prefix);
+  fs::path dir = path.has_parent_path() ? path.parent_path() : fs::path(".");
+  std::string base = path.filename().string();
+
+  static const std::regex pattern(R"(^(?:_seg\d+)?_nt_Ntuple(?:_t\d+)?\.csv$)");
+
+  std::vector<std::string> files;
+  for (const auto& entry : fs::directory_iterator(dir)) {
+    std::string name = entry.path().filename().string();
+    if (name.compare(0, base.size(), base) != 0) continue;
+    if (std::regex_match(name.substr(base.size()), pattern)) {
+      files.push_back(entry.path().string());
+    }
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// Histories of the run from its tally file, 0 if there is none
+double ReadPrimaries(const std::string& prefix)
+{
+  std::ifstream in(prefix + "_tallies.csv");
+  std::string line;
+  double primaries = 0.;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#' || line.compare(0, 5, "name,") == 0) continue;
+    std::size_t comma = line.find(',');
+    if (comma != std::string::npos) {
+      primaries = std::max(primaries, std::strtod(line.c_str() + comma + 1, nullptr));
+    }
+  }
+  return primaries;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+class Reducer
+{
+  public:
+    explicit Reducer(const Options& options)
+      : fAxis(options.bins, options.eMin, options.eMax)
+    {}
+
+    // Streams one ntuple file into the totals
+    bool Read(const std::string& file, RunSummary& summary) const
+    {
+      std::ifstream in(file);
+      if ( ! in ) {
+        std::cerr << "Cannot read " << file << std::endl;
+        return false;
+      }
+      std::vector<char> buffer(1 << 20);
+      in.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+
+      int columnE = -1, columnEdep = -1, columnEvt = -1, columnDetector = -1;
+      int columnPrimary = -1;
+      int nColumns = 0;
+      std::vector<double> values;
+      std::string line;
+
+      // Hits of the current event, per primary and detector: energy sum
+      // and count
+      long long currentEvent = std::numeric_limits<long long>::min();
+      std::map<std::pair<int, int>, std::pair<double, long long>> event;
+      bool warned = false;
+
+      while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        if (line[0] == '#') {
+          if (line.compare(0, 8, "#column ") == 0) {
+            std::string name = line.substr(line.rfind(' ') + 1);
+            if (name == "E") columnE = nColumns;
+            if (name == "Edep") columnEdep = nColumns;
+            if (name == "Evt") columnEvt = nColumns;
+            if (name == "Detector") columnDetector = nColumns;
+            if (name == "Primary") columnPrimary = nColumns;
+            ++nColumns;
+          }
+          continue;
+        }
+        if (columnE < 0 || columnEdep < 0 || columnEvt < 0 || columnDetector < 0) {
+          std::cerr << file << " lacks one of the columns E, Edep, Evt, Detector" << std::endl;
+          return false;
+        }
+
+        values.clear();
+        const char* begin = line.c_str();
+        char* end = nullptr;
+        for (int i = 0; i < nColumns; ++i) {
+          double value = std::strtod(begin, &end);
+          if (end == begin) break;
+          values.push_back(value);
+          begin = (*end == ',') ? end + 1 : end;
+        }
+        if (int(values.size()) != nColumns) continue;
+
+        long long eventID = (long long)values[columnEvt];
+        if (eventID != currentEvent) {
+          if (eventID < currentEvent && ! warned) {
+            std::cerr << "Warning: event ids decrease in " << file
+                      << ", events split across rows are counted twice" << std::endl;
+            warned = true;
+          }
+          Close(event, summary);
+          currentEvent = eventID;
+        }
+        int primary = columnPrimary >= 0 ? int(values[columnPrimary]) : 0;
+        auto& hits = event[{primary, int(values[columnDetector])}];
+        hits.first += values[columnE];
+        ++hits.second;
+        summary[int(values[columnDetector])].sumEdep += values[columnEdep];
+      }
+      Close(event, summary);
+      for (auto& [detector, total] : summary) Flush(total);
+      return true;
+    }
+
+  private:
+    void Close(std::map<std::pair<int, int>, std::pair<double, long long>>& event,
+               RunSummary& summary) const
+    {
+      for (const auto& [key, hits] : event) {
+        DetectorSummary& total = summary[key.second];
+        ++total.events;
+        total.hits += hits.second;
+        total.sumE += hits.first;
+        total.pending.push_back(hits.first);
+        if (total.pending.size() == kBatch) Flush(total);
+      }
+      event.clear();
+    }
+
+    void Flush(DetectorSummary& total) const
+    {
+      if (total.spectrum.GetNBins() == 0) total.spectrum = B2::Histogram1D<B2::LogAxis>(fAxis);
+      total.spectrum.Fill(total.pending.data(), total.pending.size());
+      total.pending.clear();
+    }
+
+    static constexpr std::size_t kBatch = 4096;
+
+    B2::LogAxis fAxis;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Merge(const RunSummary& from, RunSummary& to)
+{
+  for (const auto& [detector, summary] : from) {
+    DetectorSummary& total = to[detector];
+    total.events += summary.events;
+    total.hits += summary.hits;
+    total.sumE += summary.sumE;
+    total.sumEdep += summary.sumEdep;
+    if (total.spectrum.GetNBins() == 0) total.spectrum = summary.spectrum;
+    else total.spectrum.Add(summary.spectrum);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool ParseOptions(int argc, char** argv, Options& options)
+{
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "-j" && hasValue) options.threads = std::max(1, std::atoi(argv[++i]));
+    else if (arg == "-o" && hasValue) options.output = argv[++i];
+    else if (arg == "--primaries" && hasValue) options.primaries = std::atof(argv[++i]);
+    else if (arg == "--bins" && hasValue) options.bins = std::atoi(argv[++i]);
+    else if (arg == "--emin" && hasValue) options.eMin = std::atof(argv[++i]);
+    else if (arg == "--emax" && hasValue) options.eMax = std::atof(argv[++i]);
+    else if ( ! arg.empty() && arg[0] == '-') return false;
+    else options.prefixes.push_back(arg);
+  }
+  return ! options.prefixes.empty() && options.bins > 0 && options.eMin > 0.
+         && options.eMax > options.eMin;
+}
+
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  Options options;
+  if ( ! ParseOptions(argc, argv, options) ) {
+    std::cerr << "Usage: " << argv[0] << " [-j threads] [-o name] [--primaries n]"
+              << " [--bins n] [--emin keV] [--emax keV] <run-prefix>..." << std::endl;
+    return 1;
+  }
+
+  std::vector<Task> tasks;
+  for (std::size_t i = 0; i < options.prefixes.size(); ++i) {
+    std::vector<std::string> files = FindNtupleFiles(options.prefixes[i]);
+    if (files.empty()) {
+      std::cerr << "No ntuple files found for " << options.prefixes[i] << std::endl;
+      return 1;
+    }
+    for (const auto& file : files) tasks.push_back({i, file});
+  }
+
+  // Readers take files in turn and keep their own totals per prefix
+  Reducer reducer(options);
+  std::atomic<std::size_t> next{0};
+  std::atomic<bool> failed{false};
+  unsigned int nThreads = std::min<std::size_t>(options.threads, tasks.size());
+  std::vector<std::vector<RunSummary>> partial(nThreads,
+                                               std::vector<RunSummary>(options.prefixes.size()));
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < nThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (std::size_t i = next++; i < tasks.size(); i = next++) {
+        if ( ! reducer.Read(tasks[i].file, partial[t][tasks[i].prefix]) ) failed = true;
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  if (failed) return 1;
+
+  std::vector<RunSummary> summaries(options.prefixes.size());
+  for (const auto& threadSummaries : partial) {
+    for (std::size_t i = 0; i < summaries.size(); ++i) Merge(threadSummaries[i], summaries[i]);
+  }
+
+  std::ofstream summaryOut(options.output + "_summary.csv");
+  std::ofstream spectraOut(options.output + "_spectra.csv");
+  summaryOut << std::setprecision(std::numeric_limits<double>::max_digits10);
+  spectraOut << std::setprecision(std::numeric_limits<double>::max_digits10);
+  summaryOut << "prefix,detector,events,hits,sumE,sumEdep,countsPerUA\n";
+  spectraOut << "prefix,detector,bin,eLow,eHigh,events\n";
+
+  for (std::size_t i = 0; i < summaries.size(); ++i) {
+    const std::string& prefix = options.prefixes[i];
+    double primaries = options.primaries > 0. ? options.primaries : ReadPrimaries(prefix);
+    double microAmpereSeconds = primaries / kProtonsPerMicroAmpereSecond;
+
+    for (const auto& [detector, summary] : summaries[i]) {
+      summaryOut << prefix << "," << detector << "," << summary.events << ","
+                 << summary.hits << "," << summary.sumE << "," << summary.sumEdep << ","
+                 << (microAmpereSeconds > 0. ? summary.events / microAmpereSeconds : 0.)
+                 << "\n";
+      // Bins 1..n of the histogram, without under- and overflow
+      const B2::LogAxis& axis = summary.spectrum.GetAxis();
+      for (int bin = 0; bin < summary.spectrum.GetNBins(); ++bin) {
+        spectraOut << prefix << "," << detector << "," << bin << ","
+                   << axis.GetEdge(bin) << "," << axis.GetEdge(bin + 1) << ","
+                   << summary.spectrum.GetBins()[bin + 1].entries << "\n";
+      }
+    }
+    if (primaries <= 0.) {
+      std::cerr << "Warning: no primaries known for " << prefix
+                << ", countsPerUA set to 0 (use --primaries)" << std::endl;
+    }
+  }
+
+  std::cout << "Reduced " << tasks.size() << " files of " << summaries.size()
+            << " runs with " << nThreads << " threads into " << options.output
+            << "_summary.csv and " << options.output << "_spectra.csv" << std::endl;
+  return summaryOut && spectraOut ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+#!/bin/bash
+
+# Physics regression check for performance work: runs the reference
+# configurations (no moderator, 20 mm and 80 mm) with fixed seeds and a
+# reduced number of events, then compares the Scorer1 and Berthold spectra
+# and the tallies with stored reference runs and prints the events/s of
+# both (compareRuns). Exits with 1 if any configuration changed, else with
+# 77, which CTest reports as skipped, if a reference is missing.
+#
+# The references are committed in regression_reference/ of the source
+# tree and CTest runs every configuration as one test (ctest -R
+# regression). UPDATE=1 stores the runs as the new references instead; do
+# this only from a trusted build, with the default NEVENTS and REFERENCE
+# set to the source directory, and commit the files it writes.
+# EXE and COMPARE select the simulation and the comparison executables.
+
+set -e
+
+export NEVENTS="${NEVENTS:-100000}"
+REFERENCE="${REFERENCE:-regression_reference}"
+EXE="${EXE:-./exampleB2b}"
+COMPARE="${COMPARE:-./compareRuns}"
+THICKNESSES="${THICKNESSES:-0 20 80}"
+ALPHA="${ALPHA:-0.001}"
+
+status=0
+missing=0
+for t in $THICKNESSES
+do
+    export MODERATOR_THICKNESS="$t"
+    export RUN_ID="regression_${t}mm"
+    run="Run0_${RUN_ID}"
+    if [ "${UPDATE:-0}" != 1 ] && [ ! -f "${REFERENCE}/${run}_tallies.csv" ]; then
+        echo "No reference ${REFERENCE}/${run}_tallies.csv: store it once with" \
+             "UPDATE=1 from a trusted build and commit it"
+        missing=1
+        continue
+    fi
+    "$EXE" regression.mac > "output_${RUN_ID}.log"
+
+    if [ "${UPDATE:-0}" = 1 ]; then
+        mkdir -p "$REFERENCE"
+        cp "${run}"_h1_*.csv "${run}_tallies.csv" "${run}_stats.json" "$REFERENCE"/
+        echo "Stored ${run} as reference in ${REFERENCE}"
+    else
+        echo
+        "$COMPARE" --alpha "$ALPHA" "${REFERENCE}/${run}" "$run" ES1 E || status=1
+    fi
+done
+[ $status -eq 0 ] && [ $missing -eq 1 ] && status=77
+exit $status
@@ -0,0 +1,191 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file rngBench.cc
+/// \brief Throughput and quality smoke test of the random engines
+//
+// Usage: rngBench [numbers]
+//
+// Times flat() and flatArray() of the default MixMax engine and of
+// B2::XoshiroEngine, then checks the batched engine: mean, variance,
+// chi2 of a 1000 bin histogram, lag-1 correlation and range of its
+// output, reproducibility after reseeding and after a put()/get() round
+// trip in the middle of a buffer, and independence of the streams of
+// neighbouring event seeds. Returns 1 if a check fails.
+
+#include "XoshiroEngine.hh"
+
+#include "CLHEP/Random/MixMaxRng.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+
+// Rate in millions of numbers per second
+double TimeFlat(CLHEP::HepRandomEngine& engine, long n, double& sum)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < n; ++i) sum += engine.flat();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return n / elapsed.count() * 1.e-6;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+double TimeFlatArray(CLHEP::HepRandomEngine& engine, long n, double& sum)
+{
+  std::vector<double> values(1000);
+  auto start = std::chrono::steady_clock::now();
+  for (long i = 0; i < n; i += long(values.size())) {
+    engine.flatArray(int(values.size()), values.data());
+    sum += values[0];
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return n / elapsed.count() * 1.e-6;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool Check(const char* name, double value, double expected, double sigma)
+{
+  double pull = (value - expected) / sigma;
+  bool ok = std::fabs(pull) < 5.;
+  std::printf("  %-24s %14.8g  expected %12.8g  pull %6.2f  %s\n",
+              name, value, expected, pull, ok ? "ok" : "FAILED");
+  return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool CheckQuality(CLHEP::HepRandomEngine& engine, long n)
+{
+  const int nBins = 1000;
+  std::vector<long> bins(nBins, 0);
+  double sum = 0., sum2 = 0., sumLag = 0., previous = engine.flat();
+  double min = 1., max = 0.;
+  for (long i = 0; i < n; ++i) {
+    double x = engine.flat();
+    sum += x;
+    sum2 += x * x;
+    sumLag += (x - 0.5) * (previous - 0.5);
+    previous = x;
+    min = std::min(min, x);
+    max = std::max(max, x);
+    ++bins[std::min(int(x * nBins), nBins - 1)];
+  }
+  double mean = sum / n;
+  double var = sum2 / n - mean * mean;
+
+  double chi2 = 0., expected = double(n) / nBins;
+  for (auto count : bins) chi2 += (count - expected) * (count - expected) / expected;
+
+  bool ok = true;
+  ok &= Check("mean", mean, 0.5, std::sqrt(1. / 12. / n));
+  ok &= Check("variance", var, 1. / 12., std::sqrt(1. / 180. / n));
+  ok &= Check("chi2 (999 dof)", chi2, nBins - 1, std::sqrt(2. * (nBins - 1)));
+  ok &= Check("lag-1 correlation", sumLag / n * 12., 0., 1. / std::sqrt(double(n)));
+  bool inRange = min > 0. && max < 1.;
+  std::printf("  %-24s [%.17g, %.17g]  %s\n", "range", min, max, inRange ? "ok" : "FAILED");
+  return ok && inRange;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool CheckReproducibility()
+{
+  long seeds[4] = { 12345, 678, 0, 0 };
+  B2::XoshiroEngine a, b;
+  a.setSeeds(seeds, 4);
+  b.setSeeds(seeds, 4);
+  bool ok = true;
+  for (int i = 0; i < 1000; ++i) ok &= a.flat() == b.flat();
+  std::printf("  %-24s %s\n", "reseed", ok ? "ok" : "FAILED");
+
+  // Save in the middle of a buffer, draw, restore and draw again
+  for (int i = 0; i < 77; ++i) a.flat();
+  std::stringstream state;
+  a.put(state);
+  std::vector<unsigned long> vstate = a.put();
+  std::vector<double> first(1000), second(1000), third(1000);
+  a.flatArray(1000, first.data());
+  a.get(state);
+  a.flatArray(1000, second.data());
+  a.get(vstate);
+  a.flatArray(1000, third.data());
+  bool restored = first == second && first == third;
+  std::printf("  %-24s %s\n", "put/get", restored ? "ok" : "FAILED");
+
+  // Streams of consecutive event ids must not be correlated
+  long n = 1000000;
+  double sumProduct = 0.;
+  B2::XoshiroEngine c, d;
+  long seedsC[4] = { 1, 1000, 0, 0 };
+  long seedsD[4] = { 1, 1001, 0, 0 };
+  c.setSeeds(seedsC, 4);
+  d.setSeeds(seedsD, 4);
+  for (long i = 0; i < n; ++i) sumProduct += (c.flat() - 0.5) * (d.flat() - 0.5);
+  bool independent = Check("neighbour correlation", sumProduct / n * 12., 0.,
+                           1. / std::sqrt(double(n)));
+  return ok && restored && independent;
+}
+
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+int main(int argc, char** argv)
+{
+  long n = argc > 1 ? std::atol(argv[1]) : 100000000;
+  if (n <= 0) {
+    std::fprintf(stderr, "Usage: %s [numbers]\n", argv[0]);
+    return 1;
+  }
+
+  CLHEP::MixMaxRng mixmax;
+  B2::XoshiroEngine xoshiro;
+
+  // The sums keep the compiler from dropping the loops
+  double sum = 0.;
+  std::printf("%-16s %16s %20s\n", "engine", "flat() [M/s]", "flatArray() [M/s]");
+  for (CLHEP::HepRandomEngine* engine : { (CLHEP::HepRandomEngine*)&mixmax,
+                                          (CLHEP::HepRandomEngine*)&xoshiro }) {
+    double flat = TimeFlat(*engine, n, sum);
+    double array = TimeFlatArray(*engine, n, sum);
+    std::printf("%-16s %16.1f %20.1f\n", engine->name().c_str(), flat, array);
+  }
+
+  std::printf("\nQuality of %s (%ld numbers):\n", xoshiro.name().c_str(), std::min(n, 100000000L));
+  bool ok = CheckQuality(xoshiro, std::min(n, 100000000L));
+  ok &= CheckReproducibility();
+  std::printf("%s (checksum %g)\n", ok ? "All checks passed" : "Some checks FAILED", sum);
+  return ok ? 0 : 1;
+}
@@ -9,7 +9,7 @@ do
     export RUN_ID="${i}mm"
     export MODERATOR_THICKNESS="$i"  # cm
     cmake ..
-    make -j20
+    make -j"$(nproc)"
     echo "Running simulation with moderator thickness ${MODERATOR_THICKNESS} mm"
     ./exampleB2b run.mac > "output_${RUN_ID}.log"
 done
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# Runs run.mac as NSHARDS independent processes, each with its own event
+# range and output files, and merges the results into Run0_${RUN_ID}_merged.
+# On several machines run "./exampleB2b --shard i/N run.mac" on each one
+# and call mergeShards on the collected files instead.
+
+set -e
+
+NSHARDS="${NSHARDS:-4}"
+export MODERATOR_THICKNESS="${MODERATOR_THICKNESS:-20}"
+export RUN_ID="${RUN_ID:-${MODERATOR_THICKNESS}mm}"
+
+prefixes=()
+for ((i=0; i<NSHARDS; i++))
+do
+    ./exampleB2b --shard "${i}/${NSHARDS}" run.mac > "output_${RUN_ID}_shard${i}of${NSHARDS}.log" &
+    prefixes+=("Run0_${RUN_ID}_shard${i}of${NSHARDS}")
+done
+wait
+
+./mergeShards "Run0_${RUN_ID}_merged" "${prefixes[@]}"
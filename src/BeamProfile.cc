@@ -0,0 +1,280 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/BeamProfile.cc
+/// \brief Implementation of the B2::BeamProfile class
+
+#include "BeamProfile.hh"
+#include "EventSeeder.hh"
+
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+
+namespace B2
+{
+
+namespace
+{
+
+// splitmix64 finaliser
+std::uint64_t Mix(std::uint64_t x)
+{
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+std::uint64_t Hash(std::uint64_t a, std::uint64_t b)
+{
+  return Mix(a ^ (Mix(b) + 0x9e3779b97f4a7c15ULL + (a << 6) + (a >> 2)));
+}
+
+// [0, 1) from the upper 53 bits
+G4double ToUnit(std::uint64_t x)
+{
+  return (x >> 11) * 0x1.0p-53;
+}
+
+std::uint32_t ReverseBits(std::uint32_t x)
+{
+  x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+  x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+  x = ((x >> 4) & 0x0f0f0f0fu) | ((x & 0x0f0f0f0fu) << 4);
+  x = ((x >> 8) & 0x00ff00ffu) | ((x & 0x00ff00ffu) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+// Owen scrambling as a hash of the reversed bits (Burley, JCGT 9(4), 2020)
+std::uint32_t NestedUniformScramble(std::uint32_t x, std::uint32_t seed)
+{
+  x = ReverseBits(x);
+  x ^= x * 0x3d20adeau;
+  x += seed;
+  x *= (seed >> 16) | 1u;
+  x ^= x * 0x05526c56u;
+  x ^= x * 0x53a22864u;
+  return ReverseBits(x);
+}
+
+// Second Sobol dimension, primitive polynomial x + 1
+std::uint32_t SobolSecond(std::uint32_t index)
+{
+  std::uint32_t x = 0, direction = 0x80000000u;
+  for (; index != 0; index >>= 1) {
+    if (index & 1u) x ^= direction;
+    direction ^= direction >> 1;
+  }
+  return x;
+}
+
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+BeamProfile* BeamProfile::Instance()
+{
+  static BeamProfile instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamProfile::SetShape(Shape shape)
+{
+  if (shape == Shape::Map && fAlias.empty()) {
+    G4cout << "-->  WARNING from BeamProfile : no map loaded, profile unchanged" << G4endl;
+    return;
+  }
+  fShape = shape;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool BeamProfile::LoadMap(const G4String& fileName)
+{
+  std::ifstream in(fileName);
+  if ( ! in ) {
+    G4cout << "-->  WARNING from BeamProfile : cannot read " << fileName << G4endl;
+    return false;
+  }
+
+  G4double xMin = 0., xMax = 0., yMin = 0., yMax = 0.;
+  G4bool haveExtent = false;
+  G4int nx = 0, ny = 0;
+  std::vector<G4double> weights;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    std::istringstream stream(line);
+    if ( ! haveExtent ) {
+      haveExtent = static_cast<bool>(stream >> xMin >> xMax >> yMin >> yMax);
+      if ( ! haveExtent ) break;
+      continue;
+    }
+    G4int n = 0;
+    G4double weight;
+    while (stream >> weight) {
+      weights.push_back(std::max(weight, 0.));
+      ++n;
+    }
+    if (n == 0) continue;
+    if (nx != 0 && n != nx) {
+      G4cout << "-->  WARNING from BeamProfile : rows of " << fileName
+             << " differ in length" << G4endl;
+      return false;
+    }
+    nx = n;
+    ++ny;
+  }
+
+  G4double total = 0.;
+  for (G4double weight : weights) total += weight;
+  if ( ! haveExtent || nx == 0 || xMax <= xMin || yMax <= yMin || total <= 0.) {
+    G4cout << "-->  WARNING from BeamProfile : " << fileName << " is not a valid map" << G4endl;
+    return false;
+  }
+
+  // Vose's construction of the alias table
+  std::size_t nCells = weights.size();
+  std::vector<G4double> scaled(nCells);
+  std::vector<G4int> small, large;
+  for (std::size_t i = 0; i < nCells; ++i) {
+    scaled[i] = weights[i] * nCells / total;
+    (scaled[i] < 1. ? small : large).push_back(G4int(i));
+  }
+  fAliasProbability.assign(nCells, 1.);
+  fAlias.resize(nCells);
+  for (std::size_t i = 0; i < nCells; ++i) fAlias[i] = G4int(i);
+  while ( ! small.empty() && ! large.empty() ) {
+    G4int less = small.back();
+    small.pop_back();
+    G4int more = large.back();
+    fAliasProbability[less] = scaled[less];
+    fAlias[less] = more;
+    scaled[more] -= 1. - scaled[less];
+    if (scaled[more] < 1.) {
+      large.pop_back();
+      small.push_back(more);
+    }
+  }
+
+  fMapNx = nx;
+  fMapNy = ny;
+  fMapXMin = xMin * mm;
+  fMapYMin = yMin * mm;
+  fMapDx = (xMax - xMin) * mm / nx;
+  fMapDy = (yMax - yMin) * mm / ny;
+  G4cout << "Beam map " << fileName << ": " << nx << " x " << ny << " cells" << G4endl;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4TwoVector BeamProfile::Sample(G4long index) const
+{
+  G4double u, v;
+  GetUnitPoint(index, u, v);
+
+  G4double r = 0.;
+  switch (fShape) {
+    case Shape::Radial: r = u * fRadius; break;
+    case Shape::Disc:   r = std::sqrt(u) * fRadius; break;
+    case Shape::Gauss:  r = fSigma * std::sqrt(-2. * std::log(1. - u)); break;
+    case Shape::Map:    return SampleMap(u, v);
+  }
+  G4double angle = v * twopi;
+  return G4TwoVector(r * std::cos(angle), r * std::sin(angle));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void BeamProfile::GetUnitPoint(G4long index, G4double& u, G4double& v) const
+{
+  auto seed = std::uint64_t(EventSeeder::Instance()->GetMasterSeed());
+
+  switch (fSampling) {
+    case Sampling::Pseudo:
+      u = G4UniformRand();
+      v = G4UniformRand();
+      return;
+
+    case Sampling::Stratified: {
+      // A random rotation of the cells per block keeps a partial block unbiased
+      std::uint64_t cells = std::uint64_t(fStrata) * fStrata;
+      std::uint64_t block = std::uint64_t(index) / cells;
+      std::uint64_t cell = (std::uint64_t(index) + Hash(seed, ~block)) % cells;
+      u = (cell % fStrata + ToUnit(Hash(seed, 2 * std::uint64_t(index)))) / fStrata;
+      v = (cell / fStrata + ToUnit(Hash(seed, 2 * std::uint64_t(index) + 1))) / fStrata;
+      return;
+    }
+
+    case Sampling::Sobol: {
+      // The index is shuffled too, so consecutive events are not correlated
+      auto seeds = Hash(seed, 0x50b01ULL);
+      auto x = NestedUniformScramble(std::uint32_t(index), std::uint32_t(seeds));
+      u = NestedUniformScramble(ReverseBits(x), std::uint32_t(seeds >> 32)) * 0x1.0p-32;
+      v = NestedUniformScramble(SobolSecond(x), std::uint32_t(Mix(seeds))) * 0x1.0p-32;
+      return;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4TwoVector BeamProfile::SampleMap(G4double u, G4double v) const
+{
+  G4int nCells = G4int(fAlias.size());
+  G4double scaled = u * nCells;
+  G4int cell = std::min(G4int(scaled), nCells - 1);
+  G4double fraction = scaled - cell;
+
+  // The remainder left by the alias decision is again uniform
+  G4double probability = fAliasProbability[cell];
+  if (fraction < probability) {
+    fraction /= probability;
+  }
+  else {
+    fraction = (fraction - probability) / (1. - probability);
+    cell = fAlias[cell];
+  }
+  return G4TwoVector(fMapXMin + (cell % fMapNx + fraction) * fMapDx,
+                     fMapYMin + (cell / fMapNx + v) * fMapDy);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
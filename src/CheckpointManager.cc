@@ -0,0 +1,597 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/CheckpointManager.cc
+/// \brief Implementation of the B2::CheckpointManager class
+
+#include "CheckpointManager.hh"
+#include "EventSeeder.hh"
+#include "FileStore.hh"
+#include "TallyManager.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4AutoLock.hh"
+#include "G4Run.hh"
+#include "G4RunManager.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <regex>
+#include <sstream>
+
+namespace B2
+{
+
+G4ThreadLocal CheckpointManager::ThreadCheckpoint* CheckpointManager::fgThreadCheckpoint = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CheckpointManager::CheckpointManager()
+{
+  // One checkpoint directory per scan point, as for the output files
+  const char* runID = std::getenv("RUN_ID");
+  if (runID != NULL) fDirectory += "_" + G4String(runID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CheckpointManager* CheckpointManager::Instance()
+{
+  static CheckpointManager instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::BeamOn(G4long nEvents)
+{
+  fSegment = 0;
+  fBaseline = State();
+  fHasBaseline = false;
+
+  auto eventSeeder = EventSeeder::Instance();
+  G4long eventIdOffset = eventSeeder->GetEventIdOffset();
+
+  // Every shard keeps its own checkpoint
+  G4String directory = fDirectory;
+  fDirectory += eventSeeder->GetShardSuffix();
+
+  G4long previousEvents = 0;
+  G4String previousNtupleBase;
+  G4String engineState;
+  G4int previousSegment = -1;
+  if (ReadManifest(previousEvents, previousNtupleBase, engineState)) {
+    previousSegment = fSegment;
+
+    // Sum the last complete file of every thread of the interrupted segment
+    State segment;
+    G4String threadEngineState;
+    G4double segmentElapsed = 0.;
+    std::map<G4String, G4long> ntupleRows;
+    G4String prefix = "segment" + std::to_string(previousSegment) + "_";
+    for (const auto& entry : std::filesystem::directory_iterator(fDirectory.c_str())) {
+      G4String name = entry.path().filename().string();
+      if (name.rfind(prefix, 0) != 0 || entry.path().extension() != ".ckpt") continue;
+      std::ifstream in(entry.path());
+      State state;
+      if ( ! state.Read(in) ) {
+        G4cout << "-->  WARNING from CheckpointManager : cannot read " << name
+               << ", ignored" << G4endl;
+        continue;
+      }
+      segment.Add(state);
+      segmentElapsed = std::max(segmentElapsed, state.elapsed);
+      G4String token;
+      if (in >> token && token == "ntuple") {
+        G4long rows = 0;
+        std::string ntupleFile;
+        in >> rows >> std::ws;
+        std::getline(in, ntupleFile);
+        ntupleRows[ntupleFile] = rows;
+        in >> token;
+      }
+      if (token == "engine") {
+        threadEngineState.assign(std::istreambuf_iterator<char>(in >> std::ws),
+                                 std::istreambuf_iterator<char>());
+      }
+    }
+    fBaseline.Add(segment);
+    fBaseline.elapsed += segmentElapsed;
+    fHasBaseline = fBaseline.events > 0;
+
+    // The resumed segment processes the events after the checkpoint again
+    TruncateNtuples(previousNtupleBase, ntupleRows);
+
+    if ( ! G4Threading::IsMultithreadedApplication() && ! threadEngineState.empty() ) {
+      // Sequential: continue the stream exactly where the checkpoint left it
+      std::istringstream is(threadEngineState);
+      G4Random::getTheEngine()->get(is);
+    }
+    else {
+      // Multi-threaded: workers are reseeded per event from the master
+      // engine, which draws two numbers per event. Skipping twice the event
+      // count of the interrupted segment guarantees fresh seeds.
+      std::istringstream is(engineState);
+      G4Random::getTheEngine()->get(is);
+      std::vector<G4double> skip(65536);
+      for (G4long n = 2 * previousEvents; n > 0; n -= G4long(skip.size())) {
+        G4int chunk = G4int(std::min<G4long>(n, G4long(skip.size())));
+        G4Random::getTheEngine()->flatArray(chunk, skip.data());
+      }
+    }
+
+    fSegment = previousSegment + 1;
+
+    G4cout << ">>> Resuming from checkpoint in " << fDirectory << ": "
+           << fBaseline.events << " of " << nEvents << " events done" << G4endl;
+  }
+
+  // A completed run removes its checkpoint, so this one was killed after
+  // its last event but before writing its output
+  G4long remaining = nEvents - fBaseline.events;
+  if (remaining <= 0) {
+    G4cout << "-->  WARNING from CheckpointManager : the checkpoint in " << fDirectory
+           << " already holds " << fBaseline.events << " of " << nEvents
+           << " events but its run did not finish; no run is started. Remove "
+           << fDirectory << "/manifest to start a new run." << G4endl;
+    fDirectory = directory;
+    return;
+  }
+  if (remaining > std::numeric_limits<G4int>::max()) {
+    G4cout << "-->  WARNING from CheckpointManager : " << remaining
+           << " events exceed a single run" << G4endl;
+    fDirectory = directory;
+    return;
+  }
+
+  if (fHasBaseline) {
+    auto tallyManager = TallyManager::Instance();
+    std::vector<G4double> sum(tallyManager->GetNumberOfTallies(), 0.);
+    std::vector<G4double> sum2(tallyManager->GetNumberOfTallies(), 0.);
+    for (std::size_t i = 0; i < fBaseline.tallyNames.size(); ++i) {
+      G4int id = tallyManager->GetTallyId(fBaseline.tallyNames[i]);
+      if (id < 0) continue;
+      sum[id] = fBaseline.tallySum[i];
+      sum2[id] = fBaseline.tallySum2[i];
+    }
+    tallyManager->SetBaseline(sum, sum2, fBaseline.tallyHistories, fBaseline.elapsed);
+  }
+
+  // Resumed segments take ids above every id of the first segment of any
+  // shard, so neither events nor their per-event streams repeat
+  if (fSegment > 0) {
+    G4long total = std::max<G4long>(eventSeeder->GetTotalEvents(), nEvents);
+    eventSeeder->SetEventIdOffset(eventIdOffset + fSegment * total);
+  }
+
+  // The Evt column of the ntuple is a 32-bit integer
+  if (eventSeeder->GetGlobalEventID(G4int(remaining - 1)) > std::numeric_limits<G4int>::max()) {
+    G4cout << "-->  WARNING from CheckpointManager : segment " << fSegment
+           << " would number its events beyond " << std::numeric_limits<G4int>::max()
+           << "; no run is started" << G4endl;
+    eventSeeder->SetEventIdOffset(eventIdOffset);
+    fDirectory = directory;
+    return;
+  }
+  fRequestedEvents = nEvents;
+  G4RunManager::GetRunManager()->BeamOn(G4int(remaining));
+  fRequestedEvents = 0;
+  eventSeeder->SetEventIdOffset(eventIdOffset);
+
+  // The run has finished and written its output; a checkpoint left behind
+  // would make the next run with this directory resume it
+  if (fInterval > 0.) RemoveCheckpoint();
+  fDirectory = directory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::BeginOfRun(const G4String& ntupleBase)
+{
+  auto checkpoint = GetThreadCheckpoint();
+  checkpoint->events = 0;
+  checkpoint->maxEventID = -1;
+  checkpoint->writtenGeneration = fGeneration;
+  checkpoint->ntupleRows = 0;
+  // Named like the files of G4AnalysisManager
+  checkpoint->ntupleFile = ntupleBase;
+  if (G4Threading::IsWorkerThread()) {
+    checkpoint->ntupleFile += "_t" + std::to_string(G4Threading::G4GetThreadId());
+  }
+  checkpoint->ntupleFile += ".csv";
+
+  if ( ! G4Threading::IsMasterThread() ) return;
+
+  fNtupleBase = ntupleBase;
+
+  // Only runs started with /B2/run/beamOn are checkpointed
+  fActive = fRequestedEvents > 0 && fInterval > 0.;
+  if (fRequestedEvents == 0) {
+    fSegment = 0;
+    fBaseline = State();
+    fHasBaseline = false;
+  }
+
+  fStartTime = std::chrono::steady_clock::now();
+  fNextCheckpoint = fInterval;
+
+  if ( ! fActive ) return;
+
+  // The master engine has not produced any event seed yet
+  std::ostringstream engineState;
+  G4Random::getTheEngine()->put(engineState);
+  G4long nEvents = fBaseline.events
+    + G4RunManager::GetRunManager()->GetCurrentRun()->GetNumberOfEventToBeProcessed();
+  std::filesystem::create_directories(fDirectory.c_str());
+  WriteManifest(nEvents, engineState.str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::EndOfEvent(G4int eventID, G4long ntupleRows)
+{
+  auto checkpoint = GetThreadCheckpoint();
+  ++checkpoint->events;
+  checkpoint->ntupleRows += ntupleRows;
+  checkpoint->maxEventID = std::max(checkpoint->maxEventID,
+                                    EventSeeder::Instance()->GetGlobalEventID(eventID));
+
+  if ( ! fActive ) return;
+
+  // The first thread past the deadline opens a new checkpoint generation,
+  // every thread then writes its file after its next event
+  G4double now = GetElapsedTime();
+  G4double next = fNextCheckpoint.load();
+  if (now >= next && fNextCheckpoint.compare_exchange_strong(next, now + fInterval)) {
+    ++fGeneration;
+  }
+  if (checkpoint->writtenGeneration < fGeneration) {
+    checkpoint->writtenGeneration = fGeneration;
+    WriteThreadFile();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::EndOfRun()
+{
+  if ( ! fActive ) return;
+
+  // In multi-threaded mode the master does not process events
+  if (G4Threading::IsMasterThread() && G4Threading::IsMultithreadedApplication()) return;
+
+  WriteThreadFile();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::AddBaselineHistograms()
+{
+  if ( ! fHasBaseline ) return;
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4int nofH1s = std::min<G4int>(analysisManager->GetNofH1s(), G4int(fBaseline.histograms.size()));
+  for (G4int id = 0; id < nofH1s; ++id) {
+    auto h1 = analysisManager->GetH1(id);
+    const auto& bins = fBaseline.histograms[id];
+    if ( ! h1 || bins.size() != h1->bins_entries().size() ) continue;
+    for (std::size_t ibin = 0; ibin < bins.size(); ++ibin) {
+      h1->set_bin_content(ibin,
+                          h1->bins_entries()[ibin] + (unsigned int)bins[ibin].entries,
+                          h1->bins_sum_w()[ibin] + bins[ibin].sw,
+                          h1->bins_sum_w2()[ibin] + bins[ibin].sw2,
+                          h1->bins_sum_xw()[ibin][0] + bins[ibin].sxw,
+                          h1->bins_sum_x2w()[ibin][0] + bins[ibin].sx2w);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CheckpointManager::ThreadCheckpoint* CheckpointManager::GetThreadCheckpoint()
+{
+  if ( ! fgThreadCheckpoint ) fgThreadCheckpoint = new ThreadCheckpoint;
+  return fgThreadCheckpoint;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CheckpointManager::State CheckpointManager::CollectThreadState()
+{
+  State state;
+  auto checkpoint = GetThreadCheckpoint();
+  state.events = checkpoint->events;
+  state.maxEventID = checkpoint->maxEventID;
+  state.elapsed = GetElapsedTime();
+
+  auto tallyManager = TallyManager::Instance();
+  tallyManager->GetThreadTotals(state.tallySum, state.tallySum2, state.tallyHistories);
+  for (std::size_t i = 0; i < tallyManager->GetNumberOfTallies(); ++i) {
+    state.tallyNames.push_back(tallyManager->GetTallyName(G4int(i)));
+  }
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  for (G4int id = 0; id < analysisManager->GetNofH1s(); ++id) {
+    std::vector<Bin> bins;
+    auto h1 = analysisManager->GetH1(id);
+    if (h1) {
+      bins.resize(h1->bins_entries().size());
+      for (std::size_t ibin = 0; ibin < bins.size(); ++ibin) {
+        bins[ibin].entries = h1->bins_entries()[ibin];
+        bins[ibin].sw = h1->bins_sum_w()[ibin];
+        bins[ibin].sw2 = h1->bins_sum_w2()[ibin];
+        bins[ibin].sxw = h1->bins_sum_xw()[ibin][0];
+        bins[ibin].sx2w = h1->bins_sum_x2w()[ibin][0];
+      }
+    }
+    state.histograms.push_back(bins);
+  }
+  return state;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::WriteThreadFile()
+{
+  std::ostringstream os;
+  CollectThreadState().Write(os);
+  auto checkpoint = GetThreadCheckpoint();
+  os << "ntuple " << checkpoint->ntupleRows << " " << checkpoint->ntupleFile << "\n";
+  os << "engine\n";
+  G4Random::getTheEngine()->put(os);
+
+  G4String fileName = GetThreadFileName(fSegment, G4Threading::G4GetThreadId());
+  if ( ! FileStore::WriteFile(fileName, os.str()) ) {
+    G4cout << "-->  WARNING from CheckpointManager : cannot write " << fileName << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::WriteManifest(G4long nEvents, const G4String& engineState)
+{
+  std::ostringstream os;
+  os << "segment " << fSegment << "\n"
+     << "events " << nEvents << "\n"
+     << "ntuple " << fNtupleBase << "\n"
+     << "baseline\n";
+  fBaseline.Write(os);
+  os << "engine\n" << engineState;
+
+  G4String fileName = fDirectory + "/manifest";
+  if ( ! FileStore::WriteFile(fileName, os.str()) ) {
+    G4cout << "-->  WARNING from CheckpointManager : cannot write " << fileName << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::RemoveCheckpoint() const
+{
+  std::error_code error;
+  std::filesystem::remove(std::filesystem::path(fDirectory.c_str()) / "manifest", error);
+  for (const auto& entry : std::filesystem::directory_iterator(fDirectory.c_str(), error)) {
+    if (entry.path().filename().string().rfind("segment", 0) == 0) {
+      std::filesystem::remove(entry.path(), error);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool CheckpointManager::ReadManifest(G4long& nEvents, G4String& ntupleBase,
+                                       G4String& engineState)
+{
+  std::ifstream in(fDirectory + "/manifest");
+  if ( ! in ) return false;
+
+  G4String token;
+  G4int segment = 0;
+  if ( ! (in >> token >> segment) || token != "segment" ) return false;
+  if ( ! (in >> token >> nEvents) || token != "events" ) return false;
+  if ( ! (in >> token) || token != "ntuple" ) return false;
+  std::string base;
+  std::getline(in >> std::ws, base);
+  ntupleBase = base;
+  if ( ! (in >> token) || token != "baseline" ) return false;
+  State baseline;
+  if ( ! baseline.Read(in) ) return false;
+  if ( ! (in >> token) || token != "engine" ) return false;
+  engineState.assign(std::istreambuf_iterator<char>(in >> std::ws),
+                     std::istreambuf_iterator<char>());
+
+  fSegment = segment;
+  fBaseline = baseline;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::TruncateNtuples(const G4String& ntupleBase,
+                                        const std::map<G4String, G4long>& ntupleRows) const
+{
+  namespace fs = std::filesystem;
+  fs::path base(ntupleBase.c_str());
+  fs::path dir = base.has_parent_path() ? base.parent_path() : fs::path(".");
+  std::string prefix = base.filename().string();
+  static const std::regex threadSuffix(R"(^(?:_t\d+)?\.csv$)");
+
+  std::error_code error;
+  for (const auto& entry : fs::directory_iterator(dir, error)) {
+    std::string name = entry.path().filename().string();
+    if (name.compare(0, prefix.size(), prefix) != 0
+        || ! std::regex_match(name.substr(prefix.size()), threadSuffix)) continue;
+
+    // The file names are recorded as the threads opened them
+    G4String file = (dir / name).string();
+    if (dir == ".") file = name;
+    auto rows = ntupleRows.find(file);
+    G4long keep = rows == ntupleRows.end() ? 0 : rows->second;
+
+    // Offset after the header and the first keep complete rows
+    std::ifstream in(entry.path(), std::ios::binary);
+    std::string line;
+    std::uintmax_t offset = 0;
+    G4long kept = 0;
+    while (std::getline(in, line)) {
+      if (in.eof()) break;  // no newline: a partial row
+      if (line.empty() || line[0] != '#') {
+        if (kept == keep) break;
+        ++kept;
+      }
+      offset += line.size() + 1;
+    }
+    in.close();
+
+    if (kept < keep) {
+      G4cout << "-->  WARNING from CheckpointManager : " << name << " holds " << kept
+             << " of the " << keep << " rows of its checkpoint" << G4endl;
+    }
+    std::error_code fileError;
+    if (fs::file_size(entry.path(), fileError) > offset) {
+      fs::resize_file(entry.path(), offset, fileError);
+      if (fileError) {
+        G4cout << "-->  WARNING from CheckpointManager : cannot truncate " << name << G4endl;
+      }
+      else {
+        G4cout << "Ntuple " << name << " cut back to the " << kept
+               << " rows of its checkpoint" << G4endl;
+      }
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String CheckpointManager::GetThreadFileName(G4int segment, G4int threadId) const
+{
+  G4String thread = threadId < 0 ? G4String("master") : "t" + std::to_string(threadId);
+  return fDirectory + "/segment" + std::to_string(segment) + "_" + thread + ".ckpt";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double CheckpointManager::GetElapsedTime() const
+{
+  std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - fStartTime;
+  return elapsed.count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::State::Add(const State& other)
+{
+  events += other.events;
+  maxEventID = std::max(maxEventID, other.maxEventID);
+
+  if (tallyNames.empty()) {
+    tallyNames = other.tallyNames;
+    tallySum.assign(other.tallySum.size(), 0.);
+    tallySum2.assign(other.tallySum2.size(), 0.);
+  }
+  for (std::size_t i = 0; i < std::min(tallySum.size(), other.tallySum.size()); ++i) {
+    tallySum[i] += other.tallySum[i];
+    tallySum2[i] += other.tallySum2[i];
+  }
+  tallyHistories += other.tallyHistories;
+
+  if (histograms.size() < other.histograms.size()) histograms.resize(other.histograms.size());
+  for (std::size_t id = 0; id < other.histograms.size(); ++id) {
+    auto& bins = histograms[id];
+    const auto& otherBins = other.histograms[id];
+    if (bins.empty()) bins.resize(otherBins.size());
+    if (bins.size() != otherBins.size()) continue;
+    for (std::size_t ibin = 0; ibin < bins.size(); ++ibin) {
+      bins[ibin].entries += otherBins[ibin].entries;
+      bins[ibin].sw += otherBins[ibin].sw;
+      bins[ibin].sw2 += otherBins[ibin].sw2;
+      bins[ibin].sxw += otherBins[ibin].sxw;
+      bins[ibin].sx2w += otherBins[ibin].sx2w;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointManager::State::Write(std::ostream& os) const
+{
+  os << std::setprecision(std::numeric_limits<G4double>::max_digits10);
+  os << "events " << events << "\n"
+     << "maxEventID " << maxEventID << "\n"
+     << "elapsed " << elapsed << "\n"
+     << "tallies " << tallyNames.size() << " " << tallyHistories << "\n";
+  for (std::size_t i = 0; i < tallyNames.size(); ++i) {
+    os << tallyNames[i] << " " << tallySum[i] << " " << tallySum2[i] << "\n";
+  }
+  os << "histograms " << histograms.size() << "\n";
+  for (const auto& bins : histograms) {
+    os << bins.size() << "\n";
+    for (const auto& bin : bins) {
+      os << bin.entries << " " << bin.sw << " " << bin.sw2 << " "
+         << bin.sxw << " " << bin.sx2w << "\n";
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool CheckpointManager::State::Read(std::istream& is)
+{
+  G4String token;
+  std::size_t n = 0;
+  if ( ! (is >> token >> events) || token != "events" ) return false;
+  if ( ! (is >> token >> maxEventID) || token != "maxEventID" ) return false;
+  if ( ! (is >> token >> elapsed) || token != "elapsed" ) return false;
+  if ( ! (is >> token >> n >> tallyHistories) || token != "tallies" ) return false;
+  tallyNames.resize(n);
+  tallySum.resize(n);
+  tallySum2.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    if ( ! (is >> tallyNames[i] >> tallySum[i] >> tallySum2[i]) ) return false;
+  }
+  if ( ! (is >> token >> n) || token != "histograms" ) return false;
+  histograms.resize(n);
+  for (auto& bins : histograms) {
+    std::size_t nbins = 0;
+    if ( ! (is >> nbins) ) return false;
+    bins.resize(nbins);
+    for (auto& bin : bins) {
+      if ( ! (is >> bin.entries >> bin.sw >> bin.sw2 >> bin.sxw >> bin.sx2w) ) return false;
+    }
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
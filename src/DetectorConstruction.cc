@@ -31,6 +31,10 @@
 
 #include "DetectorConstruction.hh"
 #include "DetectorMessenger.hh"
+#include "DetectorRegistry.hh"
+#include "OverlapChecker.hh"
+#include "StartupProfiler.hh"
+#include "TallyManager.hh"
 #include "TrackerSD.hh"
 
 #include "G4Material.hh"
@@ -49,6 +53,11 @@
 
 #include "G4GeometryManager.hh"
 #include "G4GeometryTolerance.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4SolidStore.hh"
+
+#include "G4RunManager.hh"
 
 #include "G4UserLimits.hh"
 
@@ -78,11 +87,31 @@ DetectorConstruction::~DetectorConstruction() {
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4VPhysicalVolume *DetectorConstruction::Construct() {
+    auto profiler = B2::StartupProfiler::Instance();
+
     // Define materials
+    profiler->StartPhase("materials");
     DefineMaterials();
+    profiler->StopPhase();
+
+    // Define volumes, placed without checking overlaps
+    profiler->StartPhase("geometry");
+    G4VPhysicalVolume* worldPV = DefineVolumes();
+    profiler->StopPhase();
+
+    // Check the placements changed since their last check
+    if (fCheckOverlaps) {
+        profiler->StartPhase("overlap check");
+        B2::OverlapChecker checker(fOverlapCache);
+        checker.Check(worldPV);
+        profiler->StopPhase(checker.GetSummary());
+    }
 
-    // Define volumes
-    return DefineVolumes();
+    // Neutrons entering each detector per primary proton
+    for (const auto& volume : fSensitiveVolumes) {
+        B2::TallyManager::Instance()->AddTally(volume.name);
+    }
+    return worldPV;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -92,6 +121,37 @@ void DetectorConstruction::DefineMaterials() {
 
     G4NistManager *nistManager = G4NistManager::Instance();
 
+    // Materials live as long as the process: a rebuild only looks them up
+    G4bool defined = (G4Material::GetMaterial("Polyethylene", false) != nullptr);
+    if (!defined)
+        BuildMaterials();
+
+    // Keep the materials selected by /B2/det commands across rebuilds
+    if (!fTargetMaterial)
+        fTargetMaterial = nistManager->FindOrBuildMaterial("LiF");
+    if (!fModeratorMaterial)
+        fModeratorMaterial = nistManager->FindOrBuildMaterial("Plexiglass");
+    fFlangeMaterial = nistManager->FindOrBuildMaterial("Aluminum");
+    fPanelMaterial = nistManager->FindOrBuildMaterial("G4_Galactic");
+    fBertholdMaterial = nistManager->FindOrBuildMaterial("DetectorGas");
+
+    fWorldMaterial = nistManager->FindOrBuildMaterial("G4_AIR");
+
+    nistManager->FindOrBuildMaterial("G4_Galactic");
+    nistManager->FindOrBuildMaterial("G4_STAINLESS-STEEL");
+
+    // Print materials
+    if (!defined)
+        G4cout << *(G4Material::GetMaterialTable()) << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::BuildMaterials() {
+    // Elements, isotopes and materials not taken from the NIST database
+
+    G4NistManager *nistManager = G4NistManager::Instance();
+
     G4int ncomponents, natoms;
 
     G4double A; // atomic mass
@@ -151,20 +211,6 @@ void DetectorConstruction::DefineMaterials() {
     G4Element* elPE = new G4Element("TS_H_of_Polyethylene" , "H_POLYETHYLENE" , 1.0 , 1.0079*g/mole );
     G4Material* polyethylene = new G4Material("Polyethylene", 0.95*g/cm3, 1);
     polyethylene->AddElement(elPE, 2);
-
-    fTargetMaterial = nistManager->FindOrBuildMaterial("LiF");
-    fFlangeMaterial = nistManager->FindOrBuildMaterial("Aluminum");
-    fModeratorMaterial = nistManager->FindOrBuildMaterial("Plexiglass");
-    fPanelMaterial = nistManager->FindOrBuildMaterial("G4_Galactic");
-    fBertholdMaterial = nistManager->FindOrBuildMaterial("DetectorGas");
-
-    fWorldMaterial = nistManager->FindOrBuildMaterial("G4_AIR");
-
-    nistManager->FindOrBuildMaterial("G4_Galactic");
-    nistManager->FindOrBuildMaterial("G4_STAINLESS-STEEL");
-
-    // Print materials
-    G4cout << *(G4Material::GetMaterialTable()) << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -183,6 +229,16 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
 
     // Definitions of Solids, Logical Volumes, Physical Volumes
 
+    // A rebuild deletes the previous volumes first, then the vis
+    // attributes they point to
+    if (!G4PhysicalVolumeStore::GetInstance()->empty()) {
+        G4GeometryManager::GetInstance()->OpenGeometry();
+        G4PhysicalVolumeStore::Clean();
+        G4LogicalVolumeStore::Clean();
+        G4SolidStore::Clean();
+    }
+    fVisAttributes.clear();
+
     // World
 
     G4GeometryManager::GetInstance()->SetWorldMaximumExtent(1.1 * m);
@@ -201,7 +257,7 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
                                      nullptr,         // its mother  volume
                                      false,           // no boolean operations
                                      0,               // copy number
-                                     fCheckOverlaps); // checking overlaps
+                                     false);          // checked in Construct()
 
     // Target
 
@@ -214,7 +270,7 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
                       worldLV,         // its mother volume
                       false,           // no boolean operations
                       0,               // copy number
-                      fCheckOverlaps); // checking overlaps
+                      false);          // checked in Construct()
 
     G4cout << "Target is " << fTargetMaterial->GetName() << ", " << 2 * targetLength / cm << " cm long and has radius of " << targetRadius / cm << " cm" << G4endl;
 
@@ -229,7 +285,7 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
                       worldLV,         // its mother volume
                       false,           // no boolean operations
                       0,               // copy number
-                      fCheckOverlaps); // checking overlaps
+                      false);          // checked in Construct()
 
     G4cout << "Flange is " << fFlangeMaterial->GetName() << ", " << 2 * flangeLength / cm << " cm long and has radius of " << flangeRadius / cm << " cm" << G4endl;
 
@@ -250,7 +306,7 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
                         worldLV,         // its mother  volume
                         false,           // no boolean operations
                         0,               // copy number
-                        fCheckOverlaps); // checking overlaps
+                        false);          // checked in Construct()
 
     G4cout << "Panel is " << fPanelMaterial->GetName() << ", " << 2 * chamberLength / cm << " cm long and has radius of " << chamberRadius / cm << " cm" << G4endl;
 
@@ -260,14 +316,20 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
     chamberLength = 0; // half length
     chamberRadius = 0; // radius
 
+    // /B2/det/setModeratorThickness takes precedence over the environment
+    G4double thickness = fModeratorThicknessSetting;
     const char *moderatorThickness = std::getenv("MODERATOR_THICKNESS");
+    if ((thickness < 0) && (moderatorThickness != NULL))
+        thickness = std::stod(moderatorThickness) * mm;
 
     G4bool placeModerator = true;
     chamberLength = 1 * cm;  // dummy
-    if ((moderatorThickness != NULL) && (std::stod(moderatorThickness) > 0)) {
-        chamberLength = std::stod(moderatorThickness) * mm / 2;    // half length
+    if (thickness > 0) {
+        chamberLength = thickness / 2;    // half length
+        fModeratorThickness = 2 * chamberLength;
     } else {
         placeModerator = false;
+        fModeratorThickness = 0.;
     }
 
     chamberRadius = 25.0 * cm / 2; // radius
@@ -291,7 +353,7 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
                             worldLV,         // its mother  volume
                             false,           // no boolean operations
                             0,               // copy number
-                            fCheckOverlaps); // checking overlaps
+                            false);          // checked in Construct()
 
         G4cout << "Moderator is " << fModeratorMaterial->GetName() << ", " << 2 * chamberLength / cm << " cm long and has side length of " << chamberRadius / cm << " cm" << G4endl;
 
@@ -306,7 +368,7 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
                         worldLV,         // its mother  volume
                         false,           // no boolean operations
                         0,               // copy number
-                        fCheckOverlaps); // checking overlaps
+                        false);          // checked in Construct()
 
 
     G4cout << "Configuration: berthold" << G4endl;
@@ -318,8 +380,9 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
     G4Tubs *cylOuterS = new G4Tubs("CylinderO", 0, (18.9 + 1) * mm, (40 + 1) * mm / 2, 0, twopi);
     G4Sphere *sphereS = new G4Sphere("BertholdSphere", 0, chamberRadius, 0. * deg, 360. * deg, 0. * deg, 360. * deg);
 
-    G4RotationMatrix *xRot = new G4RotationMatrix;
-    xRot->rotateX(90 * deg);
+    // Owned here, a placement only points to its rotation
+    fTubeRotation = G4RotationMatrix();
+    fTubeRotation.rotateX(90 * deg);
 
     G4Material *plexiglass = G4Material::GetMaterial("Plexiglass");
     G4Material *steel = G4Material::GetMaterial("G4_STAINLESS-STEEL");
@@ -335,16 +398,16 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
                       worldLV,          // its mother  volume
                       false,            // no boolean operations
                       0,                // copy number
-                      fCheckOverlaps);  // checking overlaps
+                      false);           // checked in Construct()
 
-    new G4PVPlacement(xRot,                   // no rotation
+    new G4PVPlacement(&fTubeRotation,         // rotation
                       G4ThreeVector(0, 0, 0), // at (x,y,z)
                       HTubeLV,                // its logical volume
                       "BertholdTube",                // its name
                       SphereLV,               // its mother  volume
                       false,                  // no boolean operations
                       0,                      // copy number
-                      fCheckOverlaps);        // checking overlaps
+                      false);                 // checked in Construct()
 
     new G4PVPlacement(nullptr,
                       G4ThreeVector(0, 0, 0), // at (x,y,z)
@@ -353,25 +416,22 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
                       HTubeLV,                         // its mother  volume
                       false,                           // no boolean operations
                       0,                               // copy number
-                      fCheckOverlaps);                 // checking overlaps
-
-    // Visualization attributes
-
-    auto boxVisAtt = new G4VisAttributes(G4Colour(1.0, 1.0, 1.0));
-    worldLV->SetVisAttributes(boxVisAtt);
-
-    auto targetVisAtt = new G4VisAttributes(G4Colour(1, 1, 0));
-    fLogicTarget->SetVisAttributes(targetVisAtt);
-
-    fLogicModerator->SetVisAttributes(new G4VisAttributes(G4Colour(0.8, 0.8, 1, 0.3)));
-
-    fLogicPanel->SetVisAttributes(new G4VisAttributes(G4Colour(0.3, 0.3, 0.3, 0.9)));
-
-    SphereLV->SetVisAttributes(new G4VisAttributes(G4Colour(0.0, 0.0, 0.0, 0.4)));
-    HTubeLV->SetVisAttributes(new G4VisAttributes(G4Colour(0.8, 0.8, 0.8, 0.6)));
-    fLogicBerthold->SetVisAttributes(new G4VisAttributes(G4Colour(1.0, 0.0, 0.0, 0.2)));
-
-    fLogicScorer1->SetVisAttributes(new G4VisAttributes(G4Colour(1.0, 0.0, 0.0, 0.1)));
+                      false);                          // checked in Construct()
+
+    // Visualization attributes, owned here
+
+    auto setVisAttributes = [this](G4LogicalVolume *volume, const G4Colour &colour) {
+        fVisAttributes.push_back(std::make_unique<G4VisAttributes>(colour));
+        volume->SetVisAttributes(fVisAttributes.back().get());
+    };
+    setVisAttributes(worldLV, G4Colour(1.0, 1.0, 1.0));
+    setVisAttributes(fLogicTarget, G4Colour(1, 1, 0));
+    setVisAttributes(fLogicModerator, G4Colour(0.8, 0.8, 1, 0.3));
+    setVisAttributes(fLogicPanel, G4Colour(0.3, 0.3, 0.3, 0.9));
+    setVisAttributes(SphereLV, G4Colour(0.0, 0.0, 0.0, 0.4));
+    setVisAttributes(HTubeLV, G4Colour(0.8, 0.8, 0.8, 0.6));
+    setVisAttributes(fLogicBerthold, G4Colour(1.0, 0.0, 0.0, 0.2));
+    setVisAttributes(fLogicScorer1, G4Colour(1.0, 0.0, 0.0, 0.1));
 
     // Example of User Limits
     //
@@ -381,7 +441,8 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
     // Sets a max step length in the tracker region, with G4StepLimiter
 
     G4double maxStep = 0.1*cm;
-    fStepLimit = new G4UserLimits(maxStep);
+    if (!fStepLimit)
+        fStepLimit = new G4UserLimits(maxStep); // kept with its /B2/det/stepMax
     fLogicModerator->SetUserLimits(fStepLimit);
     fLogicPanel->SetUserLimits(fStepLimit);
     fLogicBerthold->SetUserLimits(fStepLimit);
@@ -391,6 +452,12 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
     //fLogicScorer2->SetUserLimits(fStepLimit);
     //fLogicScorer3->SetUserLimits(fStepLimit);
 
+    // Sensitive volumes, in the order of their tallies
+    fSensitiveVolumes = {
+        {fLogicModerator, "Moderator", 1, "EMod", placeModerator},
+        {fLogicBerthold, "BertholdGas", 3, "E"},
+        {fLogicScorer1, "Scorer1", 4, "ES1"}};
+
     /// Set additional contraints on the track, with G4UserSpecialCuts
     ///
     /// G4double maxLength = 2*trackerLength, maxTime = 0.1*ns, minEkin = 10*MeV;
@@ -407,27 +474,29 @@ G4VPhysicalVolume *DetectorConstruction::DefineVolumes() {
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void DetectorConstruction::ConstructSDandField() {
-    // Sensitive detectors
-
-    auto moderatorSD = new TrackerSD("ModeratorSD", "ModeratorHitsCollection");
-    G4SDManager::GetSDMpointer()->AddNewDetector(moderatorSD);
-    SetSensitiveDetector(fLogicModerator, moderatorSD);
-
-    auto panelSD = new TrackerSD("PanelSD", "PanelHitsCollection");
-    G4SDManager::GetSDMpointer()->AddNewDetector(panelSD);
-    SetSensitiveDetector(fLogicPanel, panelSD);
-
-    auto bertholdSD = new TrackerSD("BertholdSD", "BertholdHitsCollection");
-    G4SDManager::GetSDMpointer()->AddNewDetector(bertholdSD);
-    SetSensitiveDetector(fLogicBerthold, bertholdSD);
-
-    auto scorer1SD = new TrackerSD("Scorer1SD", "Scorer1HitsCollection");
-    G4SDManager::GetSDMpointer()->AddNewDetector(scorer1SD);
-    SetSensitiveDetector(fLogicScorer1, scorer1SD);
+    // Sensitive detectors, registered for the event action of this thread
+
+    auto sdManager = G4SDManager::GetSDMpointer();
+    auto registry = B2::DetectorRegistry::Instance();
+    registry->Clear();
+    for (const auto& volume : fSensitiveVolumes) {
+        G4String collection = volume.name + "HitsCollection";
+        // A geometry rebuild attaches the detectors of this thread again
+        auto sd = sdManager->FindSensitiveDetector(volume.name + "SD", false);
+        if (!sd) {
+            sd = new TrackerSD(volume.name + "SD", collection, volume.number);
+            sdManager->AddNewDetector(sd);
+        }
+        SetSensitiveDetector(volume.logical, sd);
+        registry->Register(volume.name, volume.number, volume.spectrumName,
+                           sdManager->GetCollectionID(collection), volume.placed);
+    }
 
     // Create global magnetic field messenger.
     // Uniform magnetic field is then created automatically if
     // the field value is not zero.
+    if (fMagFieldMessenger)
+        return;
     G4ThreeVector fieldValue = G4ThreeVector();
     fMagFieldMessenger = new G4GlobalMagFieldMessenger(fieldValue);
     fMagFieldMessenger->SetVerboseLevel(1);
@@ -483,4 +552,34 @@ void DetectorConstruction::SetMaxStep(G4double maxStep) {
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void DetectorConstruction::SetCheckOverlaps(G4bool checkOverlaps) {
+    fCheckOverlaps = checkOverlaps;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetOverlapCache(G4String fileName) {
+    fOverlapCache = (fileName == "none") ? "" : fileName;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetModeratorThickness(G4double thickness) {
+    // Applied by a geometry rebuild before the next run
+    fModeratorThicknessSetting = thickness;
+    auto runManager = G4RunManager::GetRunManager();
+    if (runManager && fLogicTarget) // once built
+        runManager->ReinitializeGeometry();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorConstruction::SetHitMode(G4String mode) {
+    // The sensitive detectors are per thread, the mode is shared by all
+    B2::TrackerSD::SetHitMode(mode == "track" ? B2::TrackerSD::HitMode::Track
+                                              : B2::TrackerSD::HitMode::Step);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 } // namespace B2b
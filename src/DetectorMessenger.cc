@@ -31,6 +31,7 @@
 #include "DetectorConstruction.hh"
 
 #include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 
@@ -63,6 +64,39 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction* Det)
   fStepMaxCmd->SetParameterName("stepMax",false);
   fStepMaxCmd->SetUnitCategory("Length");
   fStepMaxCmd->AvailableForStates(G4State_Idle);
+
+  fModeratorThicknessCmd = new G4UIcmdWithADoubleAndUnit("/B2/det/setModeratorThickness",this);
+  fModeratorThicknessCmd->SetGuidance("Full thickness of the moderator, 0 removes it. Overrides");
+  fModeratorThicknessCmd->SetGuidance("MODERATOR_THICKNESS; the geometry is rebuilt before the next run.");
+  fModeratorThicknessCmd->SetParameterName("thickness",false);
+  fModeratorThicknessCmd->SetRange("thickness>=0.");
+  fModeratorThicknessCmd->SetUnitCategory("Length");
+  fModeratorThicknessCmd->SetDefaultUnit("mm");
+  fModeratorThicknessCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fModeratorThicknessCmd->SetToBeBroadcasted(false);
+
+  fHitModeCmd = new G4UIcmdWithAString("/B2/det/hitMode",this);
+  fHitModeCmd->SetGuidance("Hits recorded by the sensitive detectors:");
+  fHitModeCmd->SetGuidance("  step:  one hit per step");
+  fHitModeCmd->SetGuidance("  track: one hit per track and volume, with entry and exit");
+  fHitModeCmd->SetGuidance("         energy, total deposit, path length and step count");
+  fHitModeCmd->SetParameterName("mode",false);
+  fHitModeCmd->SetCandidates("step track");
+  fHitModeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fHitModeCmd->SetToBeBroadcasted(false);
+
+  fCheckOverlapsCmd = new G4UIcmdWithABool("/B2/det/checkOverlaps",this);
+  fCheckOverlapsCmd->SetGuidance("Check the overlaps of the placements when the geometry is built.");
+  fCheckOverlapsCmd->SetParameterName("check",false);
+  fCheckOverlapsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCheckOverlapsCmd->SetToBeBroadcasted(false);
+
+  fOverlapCacheCmd = new G4UIcmdWithAString("/B2/det/overlapCache",this);
+  fOverlapCacheCmd->SetGuidance("File of the placements already found without overlaps,");
+  fOverlapCacheCmd->SetGuidance("which are not checked again while unchanged (none: no cache).");
+  fOverlapCacheCmd->SetParameterName("fileName",false);
+  fOverlapCacheCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fOverlapCacheCmd->SetToBeBroadcasted(false);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -72,6 +106,10 @@ DetectorMessenger::~DetectorMessenger()
   delete fTargMatCmd;
   delete fChamMatCmd;
   delete fStepMaxCmd;
+  delete fModeratorThicknessCmd;
+  delete fHitModeCmd;
+  delete fCheckOverlapsCmd;
+  delete fOverlapCacheCmd;
   delete fDirectory;
   delete fDetDirectory;
 }
@@ -86,6 +124,21 @@ void DetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
   if( command == fChamMatCmd )
    { fDetectorConstruction->SetChamberMaterial(newValue);}
 
+  if( command == fHitModeCmd )
+   { fDetectorConstruction->SetHitMode(newValue);}
+
+  if( command == fCheckOverlapsCmd )
+   { fDetectorConstruction
+       ->SetCheckOverlaps(fCheckOverlapsCmd->GetNewBoolValue(newValue));}
+
+  if( command == fOverlapCacheCmd )
+   { fDetectorConstruction->SetOverlapCache(newValue);}
+
+  if( command == fModeratorThicknessCmd ) {
+    fDetectorConstruction
+      ->SetModeratorThickness(fModeratorThicknessCmd->GetNewDoubleValue(newValue));
+  }
+
   if( command == fStepMaxCmd ) {
     fDetectorConstruction
       ->SetMaxStep(fStepMaxCmd->GetNewDoubleValue(newValue));
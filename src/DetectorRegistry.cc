@@ -0,0 +1,107 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/DetectorRegistry.cc
+/// \brief Implementation of the B2::DetectorRegistry class
+
+#include "DetectorRegistry.hh"
+#include "TallyManager.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4ios.hh"
+
+namespace B2
+{
+
+G4ThreadLocal DetectorRegistry* DetectorRegistry::fgInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DetectorRegistry* DetectorRegistry::Instance()
+{
+  if ( ! fgInstance ) fgInstance = new DetectorRegistry;
+  return fgInstance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DetectorRegistry::Register(const G4String& name, G4int number,
+                                 const G4String& spectrumName, G4int hitsCollectionId,
+                                 G4bool placed)
+{
+  Detector detector;
+  detector.name = name;
+  detector.number = number;
+  detector.spectrumName = spectrumName;
+  detector.hitsCollectionId = hitsCollectionId;
+  detector.placed = placed;
+
+  // Tallies are defined by the master before any thread builds its detectors
+  detector.tallyId = TallyManager::Instance()->GetTallyId(name);
+  if (detector.tallyId < 0) {
+    G4cout << "-->  WARNING from DetectorRegistry : no tally for " << name
+           << ", its histories are not scored" << G4endl;
+  }
+
+  fDetectors.push_back(detector);
+  return G4int(fDetectors.size()) - 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DetectorRegistry::ResolveHistograms()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+  for (auto& detector : fDetectors) {
+    detector.spectrumId = analysisManager->GetH1Id(detector.spectrumName, false);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t DetectorRegistry::GetNumberOfPlacedDetectors() const
+{
+  std::size_t n = 0;
+  for (const auto& detector : fDetectors) {
+    if (detector.placed) ++n;
+  }
+  return n;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const G4String& DetectorRegistry::GetName(G4int number) const
+{
+  static const G4String unknown = "unknown";
+  for (const auto& detector : fDetectors) {
+    if (detector.number == number) return detector.name;
+  }
+  return unknown;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
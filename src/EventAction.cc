@@ -31,12 +31,21 @@
 
 #include "G4Event.hh"
 #include "G4EventManager.hh"
-#include "G4TrajectoryContainer.hh"
-#include "G4Trajectory.hh"
+#include "G4HCofThisEvent.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4ios.hh"
 #include "G4AnalysisManager.hh"
+#include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
 
+#include "CheckpointManager.hh"
+#include "DetectorRegistry.hh"
+#include "EventSeeder.hh"
+#include "EventTermination.hh"
+#include "Monitor.hh"
+#include "PrimaryIndex.hh"
+#include "RunStatistics.hh"
+#include "TallyManager.hh"
 #include "TrackerHit.hh"
 
 namespace B2
@@ -44,88 +53,67 @@ namespace B2
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::BeginOfEventAction(const G4Event*)
-{}
+void EventAction::BeginOfEventAction(const G4Event* event)
+{
+  RunStatistics::Instance()->BeginOfEvent();
+  PrimaryIndex::Instance()->BeginOfEvent();
+  EventTermination::Instance()->BeginOfEvent(event);
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void EventAction::EndOfEventAction(const G4Event* event)
 {
-  // get number of stored trajectories
-
-  G4TrajectoryContainer* trajectoryContainer = event->GetTrajectoryContainer();
-  G4int n_trajectories = 0;
-  if (trajectoryContainer) n_trajectories = trajectoryContainer->entries();
+  G4int eventID = event->GetEventID();
 
-  // periodic printing
+  auto tallyManager = TallyManager::Instance();
+  auto checkpointManager = CheckpointManager::Instance();
 
-  G4int eventID = event->GetEventID();
-  if ( eventID % 10000000 == 0) {
-    G4cout << ">>> Event: " << eventID  << G4endl;
-    if ( trajectoryContainer ) {
-      G4cout << "    " << n_trajectories
-             << " trajectories stored in this event." << G4endl;
-    }
-    G4VHitsCollection* hc = event->GetHCofThisEvent()->GetHC(2);
-    G4cout << "    " << hc->GetSize() << " hits stored in this event" << G4endl;
+  // Event ids continue across the segments of a resumed run; together
+  // with the master seed they reproduce the event in per-event seeding mode
+  auto eventSeeder = EventSeeder::Instance();
+  G4long globalEventID = eventSeeder->GetGlobalEventID(eventID);
+  G4int masterSeed = -1;
+  if (eventSeeder->GetMode() == EventSeeder::Mode::PerEvent) {
+    masterSeed = G4int(eventSeeder->GetMasterSeed());
   }
 
-  // Moderator
-  G4VHitsCollection* hc = event->GetHCofThisEvent()->GetHC(0);
-  G4int nHit = hc->GetSize();
-  bool firstNeutron = true;
-  if (nHit > 0) {
-    auto analysisManager = G4AnalysisManager::Instance();
-
-    for (G4int i=0; i<nHit; i++){
-      auto hit = dynamic_cast<TrackerHit*>(hc->GetHit(i));
-      G4String particleName = hit->GetParticleName();
-      G4double E = hit->GetE();
-      G4double Edep = hit->GetEdep();
-      G4ThreeVector pos = hit->GetPos();
-      G4int chamberNb = hit->GetChamberNb();
+  // Each primary proton is a history: the first neutron it sends into a
+  // detector fills the spectrum and scores its tally
+  G4int nPrimaries = 0;
+  for (G4int i = 0; i < event->GetNumberOfPrimaryVertex(); ++i) {
+    nPrimaries += event->GetPrimaryVertex(i)->GetNumberOfParticle();
+  }
 
-      if (firstNeutron && particleName == "neutron") {
-        analysisManager->FillH1(5, E / keV);
-        analysisManager->FillNtupleDColumn(0, E / keV);
-        firstNeutron = false;
-      } 
+  const auto& detectors = DetectorRegistry::Instance()->GetDetectors();
+  fScored.resize(detectors.size());
 
-      analysisManager->FillH1(1, Edep / keV);
-      analysisManager->FillH1(2, pos.x() / cm);
-      analysisManager->FillH1(3, pos.y() / cm);
-      analysisManager->FillH1(4, pos.z() / cm);
+  auto analysisManager = G4AnalysisManager::Instance();
+  G4HCofThisEvent* hce = event->GetHCofThisEvent();
+  G4long nHits = 0;
 
-      analysisManager->FillNtupleDColumn(1, Edep / keV);
-      analysisManager->FillNtupleDColumn(2, pos.x() / cm);
-      analysisManager->FillNtupleDColumn(3, pos.y() / cm);
-      analysisManager->FillNtupleDColumn(4, pos.x() / cm);
-      analysisManager->FillNtupleIColumn(5, eventID);
-      analysisManager->FillNtupleIColumn(6, chamberNb);
-      analysisManager->AddNtupleRow();
-    }
-  }
+  for (std::size_t id = 0; id < detectors.size(); ++id) {
+    const auto& detector = detectors[id];
+    auto& scored = fScored[id];
+    scored.assign(nPrimaries, false);
 
-  // Berthold
-  hc = event->GetHCofThisEvent()->GetHC(2);
-  nHit = hc->GetSize();
-  firstNeutron = true;
-  if (nHit > 0) {
-    auto analysisManager = G4AnalysisManager::Instance();
+    auto hc = static_cast<TrackerHitsCollection*>(hce->GetHC(detector.hitsCollectionId));
+    if ( ! hc ) continue;
+    G4int nHit = G4int(hc->entries());
+    nHits += nHit;
 
     for (G4int i=0; i<nHit; i++){
-      auto hit = dynamic_cast<TrackerHit*>(hc->GetHit(i));
-      G4String particleName = hit->GetParticleName();
+      auto hit = (*hc)[i];
       G4double E = hit->GetE();
       G4double Edep = hit->GetEdep();
       G4ThreeVector pos = hit->GetPos();
-      G4int chamberNb = hit->GetChamberNb();
+      G4int primary = hit->GetPrimary();
 
-      if (firstNeutron && particleName == "neutron") {
-        analysisManager->FillH1(0, E / keV);
+      if ( ! scored[primary] && hit->GetParticleName() == "neutron") {
+        analysisManager->FillH1(detector.spectrumId, E / keV);
         analysisManager->FillNtupleDColumn(0, E / keV);
-        firstNeutron = false;
-      } 
+        scored[primary] = true;
+      }
 
       analysisManager->FillH1(1, Edep / keV);
       analysisManager->FillH1(2, pos.x() / cm);
@@ -136,48 +124,36 @@ void EventAction::EndOfEventAction(const G4Event* event)
       analysisManager->FillNtupleDColumn(2, pos.x() / cm);
       analysisManager->FillNtupleDColumn(3, pos.y() / cm);
       analysisManager->FillNtupleDColumn(4, pos.x() / cm);
-      analysisManager->FillNtupleIColumn(5, eventID);
-      analysisManager->FillNtupleIColumn(6, chamberNb);
+      analysisManager->FillNtupleIColumn(5, G4int(globalEventID));
+      analysisManager->FillNtupleIColumn(6, detector.number);
+      analysisManager->FillNtupleIColumn(7, masterSeed);
+      analysisManager->FillNtupleDColumn(8, hit->GetExitE() / keV);
+      analysisManager->FillNtupleDColumn(9, hit->GetTrackLength() / cm);
+      analysisManager->FillNtupleIColumn(10, hit->GetNSteps());
+      analysisManager->FillNtupleIColumn(11, primary);
       analysisManager->AddNtupleRow();
     }
   }
 
-  // Scorer1
-  hc = event->GetHCofThisEvent()->GetHC(3);
-  nHit = hc->GetSize();
-  firstNeutron = true;
-  if (nHit > 0) {
-    auto analysisManager = G4AnalysisManager::Instance();
-
-    for (G4int i=0; i<nHit; i++){
-      auto hit = dynamic_cast<TrackerHit*>(hc->GetHit(i));
-      G4String particleName = hit->GetParticleName();
-      G4double E = hit->GetE();
-      G4double Edep = hit->GetEdep();
-      G4ThreeVector pos = hit->GetPos();
-      G4int chamberNb = hit->GetChamberNb();
-
-      if (firstNeutron && particleName == "neutron") {
-        analysisManager->FillH1(6, E / keV);
-        analysisManager->FillNtupleDColumn(0, E / keV);
-        firstNeutron = false;
-      } 
-
-      analysisManager->FillH1(1, Edep / keV);
-      analysisManager->FillH1(2, pos.x() / cm);
-      analysisManager->FillH1(3, pos.y() / cm);
-      analysisManager->FillH1(4, pos.z() / cm);
-
-      analysisManager->FillNtupleDColumn(1, Edep / keV);
-      analysisManager->FillNtupleDColumn(2, pos.x() / cm);
-      analysisManager->FillNtupleDColumn(3, pos.y() / cm);
-      analysisManager->FillNtupleDColumn(4, pos.x() / cm);
-      analysisManager->FillNtupleIColumn(5, eventID);
-      analysisManager->FillNtupleIColumn(6, chamberNb);
-      analysisManager->AddNtupleRow();
+  auto runStatistics = RunStatistics::Instance();
+  auto termination = EventTermination::Instance();
+  if (termination->IsTerminated()) runStatistics->TerminatedEvent(termination->GetSkippedTracks());
+  runStatistics->EndOfEvent(nHits);
+  Monitor::Instance()->EndOfEvent();
+
+  // Close the history of every primary and stop once the run has converged;
+  // a detector without a tally (see DetectorRegistry::Register) is not scored
+  for (G4int primary = 0; primary < nPrimaries; ++primary) {
+    for (std::size_t id = 0; id < detectors.size(); ++id) {
+      G4int tallyId = detectors[id].tallyId;
+      if (tallyId >= 0 && fScored[id][primary]) tallyManager->Score(tallyId, 1.);
     }
+    tallyManager->EndOfHistory();
+  }
+  checkpointManager->EndOfEvent(eventID, nHits);
+  if (tallyManager->IsStopRequested()) {
+    G4RunManager::GetRunManager()->AbortRun(true);
   }
-
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,131 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/EventSeeder.cc
+/// \brief Implementation of the B2::EventSeeder class
+
+#include "EventSeeder.hh"
+#include "CheckpointManager.hh"
+
+#include "G4RunManager.hh"
+#include "G4ios.hh"
+#include "Randomize.hh"
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventSeeder* EventSeeder::Instance()
+{
+  static EventSeeder instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::SetShard(G4int index, G4int nShards)
+{
+  if (nShards < 1 || index < 0 || index >= nShards) {
+    G4cout << "-->  WARNING from EventSeeder : invalid shard " << index << "/"
+           << nShards << ", running unsharded" << G4endl;
+    return;
+  }
+  fShardIndex = index;
+  fNumberOfShards = nShards;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String EventSeeder::GetShardSuffix() const
+{
+  if (fNumberOfShards == 1) return "";
+  return "_shard" + std::to_string(fShardIndex) + "of" + std::to_string(fNumberOfShards);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::BeamOn(G4long nEvents)
+{
+  G4long first = nEvents * fShardIndex / fNumberOfShards;
+  G4long last = nEvents * (fShardIndex + 1) / fNumberOfShards;
+
+  if (fNumberOfShards > 1) {
+    G4cout << ">>> Shard " << fShardIndex << " of " << fNumberOfShards
+           << ": events " << first << " to " << last - 1 << G4endl;
+    if (fMode == Mode::Default) {
+      // Per-event streams end in 0, the shard master streams in 1
+      long seeds[4] = { long(fMasterSeed & 0xffffffff), long(fShardIndex),
+                        long(fNumberOfShards), 1 };
+      G4Random::getTheEngine()->setSeeds(seeds, 4);
+    }
+  }
+
+  G4long offset = fEventIdOffset;
+  fEventIdOffset = first;
+  fTotalEvents = nEvents;
+  CheckpointManager::Instance()->BeamOn(last - first);
+  fTotalEvents = 0;
+  fEventIdOffset = offset;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::SeedEvent(G4int eventID) const
+{
+  if (fMode != Mode::PerEvent) return;
+
+  // (master seed, event id) pick the stream, the last word is kept free
+  G4long globalEventID = GetGlobalEventID(eventID);
+  long seeds[4] = { long(fMasterSeed & 0xffffffff),
+                    long(globalEventID & 0xffffffff),
+                    long((globalEventID >> 32) & 0xffffffff),
+                    0 };
+  G4Random::getTheEngine()->setSeeds(seeds, 4);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventSeeder::ReplayEvent(G4long globalEventID)
+{
+  if (fMode != Mode::PerEvent) {
+    G4cout << "-->  WARNING from EventSeeder : events can only be replayed"
+           << " with /B2/run/seedMode event" << G4endl;
+    return;
+  }
+
+  G4cout << ">>> Replaying event " << globalEventID << " with master seed "
+         << fMasterSeed << G4endl;
+
+  G4long offset = fEventIdOffset;
+  fEventIdOffset = globalEventID;
+  G4RunManager::GetRunManager()->BeamOn(1);
+  fEventIdOffset = offset;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/EventTermination.cc
+/// \brief Implementation of the B2::EventTermination class
+
+#include "EventTermination.hh"
+#include "DetectorRegistry.hh"
+
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4StackManager.hh"
+#include "G4Track.hh"
+
+namespace B2
+{
+
+G4ThreadLocal EventTermination::ThreadState* EventTermination::fgThreadState = nullptr;
+std::atomic<EventTermination::Mode> EventTermination::fgMode{EventTermination::Mode::None};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventTermination* EventTermination::Instance()
+{
+  static EventTermination instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventTermination::BeginOfEvent(const G4Event* event)
+{
+  auto state = GetThreadState();
+  Mode mode = fgMode;
+  state->neutronsFirst = (mode != Mode::None);
+  state->active = (mode == Mode::FirstEntry);
+  state->terminated = false;
+  state->pending = 0;
+  state->skipped = 0;
+  if ( ! state->active ) return;
+
+  // The primaries exist before the event action starts. A volume left out
+  // of the geometry, such as the moderator of thickness 0, is never entered
+  G4long nPrimaries = 0;
+  for (G4int i = 0; i < event->GetNumberOfPrimaryVertex(); ++i) {
+    nPrimaries += event->GetPrimaryVertex(i)->GetNumberOfParticle();
+  }
+  state->pending = nPrimaries * G4long(DetectorRegistry::Instance()->GetNumberOfPlacedDetectors());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventTermination::FirstEntry(G4Track* track)
+{
+  auto state = GetThreadState();
+  if (state->terminated || --state->pending > 0) return;
+
+  // Every tally of the event is final: drop what is left of it
+  auto stackManager = G4EventManager::GetEventManager()->GetStackManager();
+  state->skipped += stackManager->GetNUrgentTrack() + stackManager->GetNWaitingTrack();
+  stackManager->clear();
+  track->SetTrackStatus(fKillTrackAndSecondaries);
+  state->terminated = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventTermination::ThreadState* EventTermination::GetThreadState()
+{
+  if ( ! fgThreadState ) fgThreadState = new ThreadState;
+  return fgThreadState;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
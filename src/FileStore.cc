@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/FileStore.cc
+/// \brief Implementation of the B2::FileStore class
+
+#include "FileStore.hh"
+
+#include <filesystem>
+#include <fstream>
+
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t FileStore::Hash(const std::string& text)
+{
+  std::uint64_t hash = 14695981039346656037ull;
+  for (unsigned char c : text) {
+    hash ^= c;
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FileStore::WriteFile(const G4String& fileName, const std::string& content)
+{
+  std::string temporary = fileName + ".tmp" + std::to_string(getpid());
+  {
+    std::ofstream out(temporary, std::ios::trunc);
+    out << content;
+    out.flush();
+    if ( ! out ) {
+      std::error_code error;
+      fs::remove(temporary, error);
+      return false;
+    }
+  }
+
+  std::error_code error;
+  fs::rename(temporary, std::string(fileName), error);
+  if ( ! error ) return true;
+  fs::remove(temporary, error);
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool FileStore::StoreDirectory(const G4String& directory,
+                                 const std::function<G4bool(const G4String&)>& fill)
+{
+  std::string temporary = directory + ".tmp" + std::to_string(getpid());
+  std::error_code error;
+  fs::create_directories(temporary, error);
+
+  // Renaming onto an existing non-empty directory fails
+  G4bool stored = ! error && fill(temporary);
+  if (stored) {
+    fs::rename(temporary, std::string(directory), error);
+    stored = ! error;
+  }
+  fs::remove_all(temporary, error);
+  return stored;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,425 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/Monitor.cc
+/// \brief Implementation of the B2::Monitor class
+
+#include "Monitor.hh"
+#include "TallyManager.hh"
+
+#include "G4AnalysisManager.hh"
+#include "G4AutoLock.hh"
+#include "G4ios.hh"
+
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace B2
+{
+
+G4ThreadLocal Monitor::ThreadState* Monitor::fgThreadState = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Monitor* Monitor::Instance()
+{
+  static Monitor instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Monitor::~Monitor()
+{
+  Stop();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Monitor::SetPort(G4int port)
+{
+  Stop();
+  if (port <= 0) return;
+
+#if defined(__unix__) || defined(__APPLE__)
+  fSocket = socket(AF_INET, SOCK_STREAM, 0);
+  int reuse = 1;
+  setsockopt(fSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  // Local connections only: the monitor has no authentication
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+  if (fSocket < 0 || bind(fSocket, (sockaddr*)&address, sizeof(address)) < 0
+      || listen(fSocket, 8) < 0) {
+    G4cout << "-->  WARNING from Monitor : cannot listen on 127.0.0.1:" << port
+           << ", the monitor is disabled." << G4endl;
+    if (fSocket >= 0) close(fSocket);
+    fSocket = -1;
+    return;
+  }
+
+  // Stopping the run needs a token known only to whoever reads this output
+  std::random_device device;
+  std::ostringstream token;
+  token << std::hex << std::setfill('0') << std::setw(8) << device()
+        << std::setw(8) << device() << std::setw(8) << device() << std::setw(8) << device();
+  fStopToken = token.str();
+
+  fPort = port;
+  fServing = true;
+  fActive = true;
+  fServer = std::thread(&Monitor::Serve, this);
+  G4cout << "--> Monitor: http://127.0.0.1:" << port << "/status" << G4endl
+         << "--> Monitor: stop the run with curl -X POST 'http://127.0.0.1:" << port
+         << "/stop?token=" << fStopToken << "'" << G4endl;
+#else
+  G4cout << "-->  WARNING from Monitor : not supported on this platform." << G4endl;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Monitor::Stop()
+{
+  fActive = false;
+  if ( ! fServer.joinable() ) return;
+
+  fServing = false;
+  fServer.join();
+#if defined(__unix__) || defined(__APPLE__)
+  close(fSocket);
+#endif
+  fSocket = -1;
+  fPort = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Monitor::BeginOfRun(G4int runID, G4int nEvents)
+{
+  if ( ! fgThreadState ) fgThreadState = new ThreadState;
+  fgThreadState->events = 0;
+  fgThreadState->lastSnapshot = Clock::now();
+
+  // The master begins its run before the workers start theirs
+  if ( ! G4Threading::IsMasterThread() ) return;
+
+  G4AutoLock lock(&fMutex);
+  fSnapshots.clear();
+  fRunID = runID;
+  fRequestedEvents = nEvents;
+  fRunning = true;
+  fRunStart = fgThreadState->lastSnapshot;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Monitor::CountEvent()
+{
+  auto state = fgThreadState;
+  ++state->events;
+
+  std::chrono::duration<G4double> age = Clock::now() - state->lastSnapshot;
+  if (age.count() >= fInterval) TakeSnapshot(state);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Monitor::EndOfRun()
+{
+  // Last state of the thread, before its histograms are merged and reset
+  if (fActive && fgThreadState && fgThreadState->events > 0) TakeSnapshot(fgThreadState);
+
+  if ( ! G4Threading::IsMasterThread() ) return;
+
+  G4AutoLock lock(&fMutex);
+  fRunning = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Monitor::TakeSnapshot(ThreadState* state)
+{
+  state->lastSnapshot = Clock::now();
+
+  // Copy the histograms of this thread before taking the lock
+  ThreadSnapshot snapshot;
+  snapshot.events = state->events;
+  snapshot.time = state->lastSnapshot;
+
+  auto analysisManager = G4AnalysisManager::Instance();
+  for (G4int id = 0; id < analysisManager->GetNofH1s(); ++id) {
+    auto h1 = analysisManager->GetH1(id, false, false);
+    if ( ! h1 ) continue;
+
+    HistogramSnapshot histogram;
+    histogram.name = analysisManager->GetH1Name(id);
+    histogram.nBins = h1->axis().bins();
+    histogram.min = h1->axis().lower_edge();
+    histogram.max = h1->axis().upper_edge();
+    histogram.entries.assign(h1->bins_entries().begin(), h1->bins_entries().end());
+    histogram.sumW = h1->bins_sum_w();
+    snapshot.histograms.push_back(std::move(histogram));
+  }
+
+  G4int threadId = G4Threading::IsMasterThread() ? 0 : G4Threading::G4GetThreadId();
+
+  G4AutoLock lock(&fMutex);
+  fSnapshots[threadId] = std::move(snapshot);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Monitor::Serve()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  while (fServing) {
+    // Wake up regularly to notice Stop()
+    pollfd request{fSocket, POLLIN, 0};
+    if (poll(&request, 1, 200) <= 0) continue;
+
+    int client = accept(fSocket, nullptr, nullptr);
+    if (client < 0) continue;
+    HandleRequest(client);
+    close(client);
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Monitor::HandleRequest(int client)
+{
+#if defined(__unix__) || defined(__APPLE__)
+  // A slow client must not hold up the monitor
+  timeval timeout{1, 0};
+  setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  char buffer[2048];
+  ssize_t size = recv(client, buffer, sizeof(buffer) - 1, 0);
+  if (size <= 0) return;
+  buffer[size] = '\0';
+
+  // Request line: <method> <path> HTTP/1.x
+  std::istringstream requestLine(buffer);
+  std::string method, path;
+  requestLine >> method >> path;
+
+  G4String status = "200 OK";
+  G4String body;
+  std::string stopPath = "/stop?token=" + fStopToken;
+  if (path == "/stop" || path.compare(0, 6, "/stop?") == 0) {
+    // The only request that changes the run
+    if (method != "POST") {
+      status = "405 Method Not Allowed";
+      body = "{\"error\": \"use POST /stop?token=<token>\"}";
+    }
+    else if (path != stopPath) {
+      status = "403 Forbidden";
+      body = "{\"error\": \"missing or wrong token\"}";
+    }
+    else {
+      TallyManager::Instance()->RequestStop();
+      body = "{\"stop\": true}";
+    }
+  }
+  else if (method != "GET") {
+    status = "405 Method Not Allowed";
+    body = "{\"error\": \"only GET is supported\"}";
+  }
+  else if (path == "/" || path == "/status") {
+    body = GetStatus();
+  }
+  else if (path == "/h1") {
+    body = GetHistogramNames();
+  }
+  else if (path.compare(0, 4, "/h1/") == 0) {
+    body = GetHistogram(path.substr(4));
+    if (body.empty()) status = "404 Not Found";
+  }
+  else {
+    status = "404 Not Found";
+  }
+  if (body.empty()) body = "{\"error\": \"not found\"}";
+
+  std::ostringstream response;
+  response << "HTTP/1.0 " << status << "\r\n"
+           << "Content-Type: application/json\r\n"
+           << "Content-Length: " << body.size() + 1 << "\r\n"
+           << "Connection: close\r\n\r\n"
+           << body << "\n";
+  std::string text = response.str();
+
+  int flags = 0;
+#ifdef MSG_NOSIGNAL
+  flags = MSG_NOSIGNAL;
+#endif
+  for (std::size_t sent = 0; sent < text.size();) {
+    ssize_t n = send(client, text.data() + sent, text.size() - sent, flags);
+    if (n <= 0) return;
+    sent += n;
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String Monitor::GetStatus()
+{
+  std::map<G4int, ThreadSnapshot> snapshots;
+  G4int runID, requested;
+  G4bool running;
+  Clock::time_point start;
+  {
+    G4AutoLock lock(&fMutex);
+    for (const auto& [threadId, snapshot] : fSnapshots) {
+      snapshots[threadId].events = snapshot.events;
+      snapshots[threadId].time = snapshot.time;
+    }
+    runID = fRunID;
+    requested = fRequestedEvents;
+    running = fRunning;
+    start = fRunStart;
+  }
+
+  auto now = Clock::now();
+  std::chrono::duration<G4double> elapsed = now - start;
+  G4long events = 0;
+  for (const auto& [threadId, snapshot] : snapshots) events += snapshot.events;
+
+  std::vector<G4double> mean, relError;
+  G4long histories = 0;
+  TallyManager::Instance()->GetResults(mean, relError, histories);
+
+  std::ostringstream out;
+  out << std::setprecision(6)
+      << "{\n  \"run\": " << runID << ",\n"
+      << "  \"running\": " << (running ? "true" : "false") << ",\n"
+      << "  \"elapsed_s\": " << (runID >= 0 ? elapsed.count() : 0.) << ",\n"
+      << "  \"events\": " << events << ",\n"
+      << "  \"eventsRequested\": " << requested << ",\n"
+      << "  \"eventsPerSecond\": "
+      << (elapsed.count() > 0. && runID >= 0 ? events / elapsed.count() : 0.) << ",\n"
+      << "  \"perThread\": [";
+  G4bool first = true;
+  for (const auto& [threadId, snapshot] : snapshots) {
+    std::chrono::duration<G4double> age = now - snapshot.time;
+    out << (first ? "" : ",") << "\n    {\"thread\": " << threadId
+        << ", \"events\": " << snapshot.events << ", \"snapshotAge_s\": " << age.count() << "}";
+    first = false;
+  }
+  out << "\n  ],\n"
+      << "  \"tallyHistories\": " << histories << ",\n"
+      << "  \"tallies\": [";
+  auto tallyManager = TallyManager::Instance();
+  for (std::size_t i = 0; i < mean.size(); ++i) {
+    out << (i ? "," : "") << "\n    {\"name\": \"" << tallyManager->GetTallyName(G4int(i))
+        << "\", \"mean\": " << mean[i] << ", \"relError\": " << relError[i] << "}";
+  }
+  out << "\n  ]\n}";
+  return out.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String Monitor::GetHistogramNames()
+{
+  std::vector<G4String> names;
+  {
+    G4AutoLock lock(&fMutex);
+    if ( ! fSnapshots.empty() ) {
+      for (const auto& histogram : fSnapshots.begin()->second.histograms) {
+        names.push_back(histogram.name);
+      }
+    }
+  }
+
+  std::ostringstream out;
+  out << "[";
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    out << (i ? ", " : "") << "\"" << names[i] << "\"";
+  }
+  out << "]";
+  return out.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String Monitor::GetHistogram(const G4String& name)
+{
+  // Copy the bins of every thread, sum them without the lock
+  std::vector<HistogramSnapshot> copies;
+  {
+    G4AutoLock lock(&fMutex);
+    for (const auto& [threadId, snapshot] : fSnapshots) {
+      for (const auto& histogram : snapshot.histograms) {
+        if (histogram.name == name) copies.push_back(histogram);
+      }
+    }
+  }
+  if (copies.empty()) return "";
+
+  HistogramSnapshot merged = copies[0];
+  for (std::size_t i = 1; i < copies.size(); ++i) {
+    if (copies[i].sumW.size() != merged.sumW.size()) continue;
+    for (std::size_t bin = 0; bin < merged.sumW.size(); ++bin) {
+      merged.entries[bin] += copies[i].entries[bin];
+      merged.sumW[bin] += copies[i].sumW[bin];
+    }
+  }
+
+  // Bin 0 is the underflow and bin nBins + 1 the overflow
+  std::ostringstream out;
+  out << std::setprecision(10)
+      << "{\"name\": \"" << merged.name << "\", \"threads\": " << copies.size()
+      << ", \"nBins\": " << merged.nBins << ", \"min\": " << merged.min
+      << ", \"max\": " << merged.max << ",\n \"entries\": [";
+  for (std::size_t bin = 0; bin < merged.entries.size(); ++bin) {
+    out << (bin ? "," : "") << merged.entries[bin];
+  }
+  out << "],\n \"sumW\": [";
+  for (std::size_t bin = 0; bin < merged.sumW.size(); ++bin) {
+    out << (bin ? "," : "") << merged.sumW[bin];
+  }
+  out << "]}";
+  return out.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,190 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/OverlapChecker.cc
+/// \brief Implementation of the B2::OverlapChecker class
+
+#include "OverlapChecker.hh"
+#include "FileStore.hh"
+
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VSolid.hh"
+#include "G4ios.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OverlapChecker::Check(G4VPhysicalVolume* world)
+{
+  ReadCache();
+
+  std::set<const G4LogicalVolume*> visited;
+  Visit(world->GetLogicalVolume(), visited);
+
+  WriteCache();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String OverlapChecker::GetSummary() const
+{
+  std::ostringstream summary;
+  summary << fChecked << " placements checked";
+  if ( ! fCacheFile.empty() ) summary << ", " << fSkipped << " unchanged in " << fCacheFile;
+  if (fOverlaps > 0) summary << ", " << fOverlaps << " with overlaps";
+  return summary.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OverlapChecker::Visit(const G4LogicalVolume* mother,
+                           std::set<const G4LogicalVolume*>& visited)
+{
+  // A logical volume placed several times has the same daughters
+  if ( ! visited.insert(mother).second ) return;
+
+  for (std::size_t i = 0; i < mother->GetNoDaughters(); ++i) {
+    G4VPhysicalVolume* daughter = mother->GetDaughter(i);
+    G4bool placement = ! daughter->IsReplicated() && ! daughter->IsParameterised();
+
+    std::uint64_t fingerprint = placement ? Fingerprint(daughter, mother) : 0;
+    if (placement && fCached.count(fingerprint) > 0) {
+      ++fSkipped;
+    }
+    else {
+      ++fChecked;
+      if (daughter->CheckOverlaps(fResolution, fTolerance)) {
+        ++fOverlaps;
+      }
+      else if (placement) {
+        fCached.insert(fingerprint);
+        fVerified.push_back({fingerprint, daughter->GetName()});
+      }
+    }
+    Visit(daughter->GetLogicalVolume(), visited);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::uint64_t OverlapChecker::Fingerprint(const G4VPhysicalVolume* volume,
+                                          const G4LogicalVolume* mother) const
+{
+  std::ostringstream text;
+  text << std::setprecision(std::numeric_limits<G4double>::max_digits10)
+       << "resolution " << fResolution << " tolerance " << fTolerance << "\n";
+  Describe(text, volume);
+  text << "mother\n";
+  mother->GetSolid()->StreamInfo(text);
+  for (std::size_t i = 0; i < mother->GetNoDaughters(); ++i) {
+    const G4VPhysicalVolume* sister = mother->GetDaughter(i);
+    if (sister == volume) continue;
+    text << "sister\n";
+    Describe(text, sister);
+  }
+
+  return FileStore::Hash(text.str());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OverlapChecker::Describe(std::ostream& os, const G4VPhysicalVolume* volume)
+{
+  os << volume->GetName() << " " << volume->GetCopyNo()
+     << " translation " << volume->GetTranslation() << " rotation";
+  const auto* rotation = volume->GetRotation();
+  if (rotation) {
+    os << " " << rotation->xx() << " " << rotation->xy() << " " << rotation->xz()
+       << " " << rotation->yx() << " " << rotation->yy() << " " << rotation->yz()
+       << " " << rotation->zx() << " " << rotation->zy() << " " << rotation->zz();
+  }
+  os << "\n";
+  volume->GetLogicalVolume()->GetSolid()->StreamInfo(os);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OverlapChecker::ReadCache()
+{
+  if (fCacheFile.empty()) return;
+
+  std::ifstream in(fCacheFile);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    try {
+      fCached.insert(std::stoull(line.substr(0, line.find(' ')), nullptr, 16));
+    }
+    catch (const std::exception&) {
+      G4cout << "-->  WARNING from OverlapChecker : ignoring line \"" << line
+             << "\" of " << fCacheFile << G4endl;
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void OverlapChecker::WriteCache() const
+{
+  if (fCacheFile.empty() || fVerified.empty()) return;
+
+  // The entries of other geometries sharing the file are kept, including
+  // those another process stored since ReadCache()
+  std::vector<std::string> lines;
+  std::set<std::string> fingerprints;
+  std::ifstream in(fCacheFile);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+    if (fingerprints.insert(line.substr(0, line.find(' '))).second) lines.push_back(line);
+  }
+  for (const auto& entry : fVerified) {
+    std::ostringstream text;
+    text << std::hex << std::setw(16) << std::setfill('0') << entry.fingerprint
+         << std::dec << " " << entry.name;
+    line = text.str();
+    if (fingerprints.insert(line.substr(0, line.find(' '))).second) lines.push_back(line);
+  }
+
+  std::ostringstream out;
+  out << "# B2::OverlapChecker fingerprints of placements without overlaps\n";
+  for (const auto& cached : lines) out << cached << "\n";
+  if ( ! FileStore::WriteFile(fCacheFile, out.str()) ) {
+    G4cout << "-->  WARNING from OverlapChecker : cannot write " << fCacheFile << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
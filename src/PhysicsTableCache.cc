@@ -0,0 +1,178 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/PhysicsTableCache.cc
+/// \brief Implementation of the B2::PhysicsTableCache class
+
+#include "PhysicsTableCache.hh"
+#include "FileStore.hh"
+
+#include "G4Element.hh"
+#include "G4EmParameters.hh"
+#include "G4IonisParamMat.hh"
+#include "G4Material.hh"
+#include "G4ProductionCuts.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4StateManager.hh"
+#include "G4Threading.hh"
+#include "G4VUserPhysicsList.hh"
+#include "G4Version.hh"
+#include "G4ios.hh"
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsTableCache* PhysicsTableCache::Instance()
+{
+  // Not a static object: the G4StateManager deletes its dependents
+  static auto instance = new PhysicsTableCache;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsTableCache::SetPhysicsList(G4VUserPhysicsList* physicsList,
+                                       const G4String& name)
+{
+  fPhysicsList = physicsList;
+  fName = name;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool PhysicsTableCache::Notify(G4ApplicationState requestedState)
+{
+  // The cuts and couples are final when a run initialisation starts,
+  // before the physics tables are built
+  auto current = G4StateManager::GetStateManager()->GetCurrentState();
+  if (requestedState != G4State_Init || current != G4State_Idle) return true;
+  if ( ! fPhysicsList || ! G4Threading::IsMasterThread() ) return true;
+
+  fEntry.clear();
+  if (fDirectory.empty()) {
+    fPhysicsList->ResetPhysicsTableRetrieved();
+    return true;
+  }
+
+  fDescription = Describe();
+  std::ostringstream entry;
+  entry << fDirectory << "/" << std::hex << std::setw(16) << std::setfill('0')
+        << FileStore::Hash(fDescription);
+
+  if (std::filesystem::exists(entry.str() + "/key.txt")) {
+    G4cout << "Physics tables retrieved from " << entry.str() << G4endl;
+    fPhysicsList->SetPhysicsTableRetrieved(entry.str());
+  }
+  else {
+    fPhysicsList->ResetPhysicsTableRetrieved();
+    fEntry = entry.str();
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsTableCache::BeginOfRun()
+{
+  if ( ! G4Threading::IsMasterThread() || fEntry.empty() ) return;
+
+  std::string entry = fEntry;
+  fEntry.clear();
+
+  // Another process may store the same entry
+  G4bool stored = FileStore::StoreDirectory(entry, [this](const G4String& temporary) {
+    if ( ! fPhysicsList->StorePhysicsTable(temporary) ) return false;
+    std::ofstream key(temporary + "/key.txt");
+    key << fDescription;
+    return static_cast<G4bool>(key);
+  });
+  if (stored) {
+    G4cout << "Physics tables stored in " << entry << G4endl;
+    return;
+  }
+  // Already stored by a concurrent process
+  if ( ! std::filesystem::exists(entry + "/key.txt") ) {
+    G4cout << "-->  WARNING from PhysicsTableCache : cannot store the physics tables in "
+           << entry << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String PhysicsTableCache::Describe() const
+{
+  std::ostringstream text;
+  text << std::setprecision(std::numeric_limits<G4double>::max_digits10)
+       << "physics list " << fName << "\n"
+       << "geant4 " << G4Version << "\n"
+       << "default cut " << fPhysicsList->GetDefaultCutValue() << "\n";
+
+  auto cutsTable = G4ProductionCutsTable::GetProductionCutsTable();
+  text << "energy range " << cutsTable->GetLowEdgeEnergy() << " "
+       << cutsTable->GetHighEdgeEnergy() << "\n";
+
+  G4EmParameters::Instance()->StreamInfo(text);
+
+  // The table index of a material is part of the stored tables
+  for (const auto material : *G4Material::GetMaterialTable()) {
+    text << "material " << material->GetName() << " " << material->GetDensity() << " "
+         << material->GetState() << " " << material->GetTemperature() << " "
+         << material->GetPressure() << " "
+         << material->GetIonisation()->GetMeanExcitationEnergy() << "\n";
+    const G4double* fractions = material->GetFractionVector();
+    for (std::size_t i = 0; i < material->GetNumberOfElements(); ++i) {
+      const G4Element* element = material->GetElement(i);
+      text << "  " << element->GetName() << " " << element->GetZ() << " "
+           << element->GetN() << " " << fractions[i] << "\n";
+    }
+  }
+
+  for (const auto region : *G4RegionStore::GetInstance()) {
+    text << "region " << region->GetName();
+    if (auto cuts = region->GetProductionCuts()) {
+      for (const char* particle : {"gamma", "e-", "e+", "proton"}) {
+        text << " " << cuts->GetProductionCut(particle);
+      }
+    }
+    text << "\n";
+  }
+  return text.str();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -28,6 +28,8 @@
 /// \brief Implementation of the B2::PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.hh"
+#include "BeamProfile.hh"
+#include "EventSeeder.hh"
 
 #include "G4LogicalVolumeStore.hh"
 #include "G4LogicalVolume.hh"
@@ -37,12 +39,12 @@
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4SystemOfUnits.hh"
-#include "Randomize.hh"
-#include "G4PhysicalConstants.hh"
 
 namespace B2
 {
 
+std::atomic<G4int> PrimaryGeneratorAction::fgPrimariesPerEvent{1};
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PrimaryGeneratorAction::PrimaryGeneratorAction()
@@ -73,34 +75,45 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
   // This function is called at the begining of event
 
+  // Per-event seeding makes the event independent of the thread running it
+  auto eventSeeder = EventSeeder::Instance();
+  eventSeeder->SeedEvent(anEvent->GetEventID());
+
   // In order to avoid dependence of PrimaryGeneratorAction
   // on DetectorConstruction class we get world volume
   // from G4LogicalVolumeStore.
-
-  G4double worldZHalfLength = 0;
-  G4LogicalVolume* worldLV = G4LogicalVolumeStore::GetInstance()->GetVolume("World");
-  G4Box* worldBox = nullptr;
-  if ( worldLV ) worldBox = dynamic_cast<G4Box*>(worldLV->GetSolid());
-  if ( worldBox ) worldZHalfLength = worldBox->GetZHalfLength();
-  else  {
-    G4cerr << "World volume of box not found." << G4endl;
-    G4cerr << "Perhaps you have changed geometry." << G4endl;
-    G4cerr << "The gun will be place in the center." << G4endl;
+  // The gun does not depend on it, so the store is only searched once.
+
+  if ( ! fWorldChecked ) {
+    fWorldChecked = true;
+    G4double worldZHalfLength = 0;
+    G4LogicalVolume* worldLV = G4LogicalVolumeStore::GetInstance()->GetVolume("World");
+    G4Box* worldBox = nullptr;
+    if ( worldLV ) worldBox = dynamic_cast<G4Box*>(worldLV->GetSolid());
+    if ( worldBox ) worldZHalfLength = worldBox->GetZHalfLength();
+    else  {
+      G4cerr << "World volume of box not found." << G4endl;
+      G4cerr << "Perhaps you have changed geometry." << G4endl;
+      G4cerr << "The gun will be place in the center." << G4endl;
+    }
   }
 
   // Note that this particular case of starting a primary particle on the world boundary
   // requires shooting in a direction towards inside the world.
   //fParticleGun->SetParticlePosition(G4ThreeVector(0., 0., -worldZHalfLength));
 
-  // sample random x and y so they are within a circle of 2 cm diameter
-  G4double r = G4UniformRand()*19*mm;
-  G4double angle = G4UniformRand()*2*pi;
-  G4double x = r*cos(angle);
-  G4double y = r*sin(angle);
-  
-  fParticleGun->SetParticlePosition(G4ThreeVector(x, y, -1*cm));
+  // One vertex per primary; their track ids 1..K identify them in the hits
+  // The beam spot is sampled by the global index of the primary
+  G4int nPrimaries = fgPrimariesPerEvent;
+  auto beamProfile = BeamProfile::Instance();
+  G4long firstSample = eventSeeder->GetGlobalEventID(anEvent->GetEventID()) * nPrimaries;
+  for (G4int i = 0; i < nPrimaries; ++i) {
+    G4TwoVector position = beamProfile->Sample(firstSample + i);
 
-  fParticleGun->GeneratePrimaryVertex(anEvent);
+    fParticleGun->SetParticlePosition(G4ThreeVector(position.x(), position.y(), -1*cm));
+
+    fParticleGun->GeneratePrimaryVertex(anEvent);
+  }
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/PrimaryIndex.cc
+/// \brief Implementation of the B2::PrimaryIndex class
+
+#include "PrimaryIndex.hh"
+
+#include "G4Track.hh"
+
+namespace B2
+{
+
+G4ThreadLocal std::vector<G4int>* PrimaryIndex::fgPrimaryOfTrack = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PrimaryIndex* PrimaryIndex::Instance()
+{
+  static PrimaryIndex instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryIndex::StartTrack(const G4Track* track)
+{
+  auto table = GetThreadTable();
+  G4int trackID = track->GetTrackID();
+  G4int parentID = track->GetParentID();
+
+  G4int primary = (parentID == 0) ? trackID - 1 : GetPrimary(parentID);
+  if (trackID >= G4int(table->size())) table->resize(trackID + 1, 0);
+  (*table)[trackID] = primary;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<G4int>* PrimaryIndex::GetThreadTable()
+{
+  // Keeps its capacity from event to event
+  if ( ! fgPrimaryOfTrack ) fgPrimaryOfTrack = new std::vector<G4int>;
+  return fgPrimaryOfTrack;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
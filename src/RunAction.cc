@@ -28,6 +28,16 @@
 /// \brief Implementation of the B2::RunAction class
 
 #include "RunAction.hh"
+#include "CheckpointManager.hh"
+#include "DetectorRegistry.hh"
+#include "EventSeeder.hh"
+#include "Monitor.hh"
+#include "PhysicsTableCache.hh"
+#include "RunMessenger.hh"
+#include "RunStatistics.hh"
+#include "StartupProfiler.hh"
+#include "SteppingProfiler.hh"
+#include "TallyManager.hh"
 
 #include "G4Run.hh"
 #include "G4RunManager.hh"
@@ -42,6 +52,19 @@ namespace B2
 RunAction::RunAction()
 {
   G4RunManager::GetRunManager()->SetPrintProgress(1000000);
+
+  // The tallies are defined with the sensitive volumes
+  if (G4Threading::IsMasterThread()) {
+    fMessenger = new RunMessenger();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunAction::~RunAction()
+{
+  if (IsMaster()) Monitor::Instance()->Stop();
+  delete fMessenger;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -49,6 +72,7 @@ RunAction::RunAction()
 void RunAction::BeginOfRunAction(const G4Run* run)
 {
   //inform the runManager to save random number seed
+  //(engine states are kept in the checkpoint files instead)
   G4RunManager::GetRunManager()->SetRandomNumberStore(false);
 
   auto analysisManager = G4AnalysisManager::Instance();
@@ -64,12 +88,40 @@ void RunAction::BeginOfRunAction(const G4Run* run)
     identifier = "";
   }
 
-  G4String fileName = "Run" + runnumber + identifier + ".csv";
+  // Shards of one configuration write side by side without any locking
+  identifier += EventSeeder::Instance()->GetShardSuffix();
+
+  // A resumed run writes its ntuples next to those of the earlier segments
+  G4int segment = CheckpointManager::Instance()->GetSegment();
+  if (segment > 0) identifier += "_seg" + std::to_string(segment);
+
+  fFileBase = "Run" + runnumber + identifier;
+  G4String fileName = fFileBase + ".csv";
 
   //analysisManager->SetNtupleMerging(false);
   analysisManager->OpenFile(fileName);
 
-  // Hists
+  TallyManager::Instance()->BeginOfRun();
+  CheckpointManager::Instance()->BeginOfRun(fFileBase + "_nt_Ntuple");
+  RunStatistics::Instance()->BeginOfRun();
+  StartupProfiler::Instance()->BeginOfRun();
+  PhysicsTableCache::Instance()->BeginOfRun();
+  SteppingProfiler::Instance()->BeginOfRun();
+  Monitor::Instance()->BeginOfRun(run->GetRunID(), run->GetNumberOfEventToBeProcessed());
+
+  // Histograms and ntuples are booked once per process; later runs
+  // (replays, resumed segments) refill them
+  if (analysisManager->GetNofH1s() == 0) Book();
+  DetectorRegistry::Instance()->ResolveHistograms();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunAction::Book()
+{
+  auto analysisManager = G4AnalysisManager::Instance();
+
+  // Hists; the spectra of the detectors are found by name
   analysisManager->CreateH1("E", "Incoming energy (keV)", 200, 0, 10000);
   analysisManager->CreateH1("Edep", "Deposited energy (keV)", 200, 0, 10000);
   analysisManager->CreateH1("X", "X-coordinate (cm)", 100, -3, 3);
@@ -87,14 +139,34 @@ void RunAction::BeginOfRunAction(const G4Run* run)
   analysisManager->CreateNtupleDColumn("Z");
   analysisManager->CreateNtupleIColumn("Evt");
   analysisManager->CreateNtupleIColumn("Detector");
+  analysisManager->CreateNtupleIColumn("Seed");
+  analysisManager->CreateNtupleDColumn("ExitE");
+  analysisManager->CreateNtupleDColumn("Length");
+  analysisManager->CreateNtupleIColumn("Steps");
+  analysisManager->CreateNtupleIColumn("Primary");
   analysisManager->FinishNtuple();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void RunAction::EndOfRunAction(const G4Run* ){
+void RunAction::EndOfRunAction(const G4Run* run){
+  TallyManager::Instance()->EndOfRun();
+  CheckpointManager::Instance()->EndOfRun();
+  RunStatistics::Instance()->EndOfRun();
+  SteppingProfiler::Instance()->EndOfRun();
+  StartupProfiler::Instance()->EndOfRun();
+  Monitor::Instance()->EndOfRun();
+
   auto analysisManager = G4AnalysisManager::Instance();
 
+  // Histograms of the workers are merged by now, add earlier segments
+  if (IsMaster()) {
+    CheckpointManager::Instance()->AddBaselineHistograms();
+    TallyManager::Instance()->Write(fFileBase + "_tallies.csv");
+    RunStatistics::Instance()->Write(fFileBase + "_stats.json", run->GetRunID());
+    SteppingProfiler::Instance()->Write(fFileBase + "_profile.csv");
+  }
+
   analysisManager->Write();
   analysisManager->CloseFile();
 }
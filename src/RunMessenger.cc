@@ -0,0 +1,506 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/RunMessenger.cc
+/// \brief Implementation of the B2::RunMessenger class
+
+#include "RunMessenger.hh"
+#include "BeamProfile.hh"
+#include "CheckpointManager.hh"
+#include "EventSeeder.hh"
+#include "EventTermination.hh"
+#include "Monitor.hh"
+#include "PhysicsTableCache.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "RunStatistics.hh"
+#include "SteppingProfiler.hh"
+#include "SweepRunner.hh"
+#include "TallyManager.hh"
+#include "ThreadPlacement.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4SystemOfUnits.hh"
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunMessenger::RunMessenger()
+{
+  fRunDirectory = new G4UIdirectory("/B2/run/");
+  fRunDirectory->SetGuidance("Run control: tally convergence and stopping");
+
+  fTargetRelErrorCmd = new G4UIcmdWithADouble("/B2/run/targetRelError",this);
+  fTargetRelErrorCmd->SetGuidance("Stop the run once the selected tallies reach");
+  fTargetRelErrorCmd->SetGuidance("this relative error (0 disables).");
+  fTargetRelErrorCmd->SetParameterName("relError",false);
+  fTargetRelErrorCmd->SetRange("relError>=0.");
+  fTargetRelErrorCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fTargetRelErrorCmd->SetToBeBroadcasted(false);
+
+  fStopTalliesCmd = new G4UIcmdWithAString("/B2/run/stopTallies",this);
+  fStopTalliesCmd->SetGuidance("Space separated tallies checked by /B2/run/targetRelError");
+  fStopTalliesCmd->SetGuidance("(Moderator, BertholdGas, Scorer1 or all).");
+  fStopTalliesCmd->SetParameterName("names",false);
+  fStopTalliesCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fStopTalliesCmd->SetToBeBroadcasted(false);
+
+  fMaxWallTimeCmd = new G4UIcmdWithADoubleAndUnit("/B2/run/maxWallTime",this);
+  fMaxWallTimeCmd->SetGuidance("Stop the run after this wall-clock time (0 disables).");
+  fMaxWallTimeCmd->SetParameterName("time",false);
+  fMaxWallTimeCmd->SetUnitCategory("Time");
+  fMaxWallTimeCmd->SetDefaultUnit("s");
+  fMaxWallTimeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMaxWallTimeCmd->SetToBeBroadcasted(false);
+
+  fPrintIntervalCmd = new G4UIcmdWithADoubleAndUnit("/B2/run/printInterval",this);
+  fPrintIntervalCmd->SetGuidance("Wall-clock interval between tally and throughput");
+  fPrintIntervalCmd->SetGuidance("progress prints (0 disables the throughput line).");
+  fPrintIntervalCmd->SetParameterName("interval",false);
+  fPrintIntervalCmd->SetUnitCategory("Time");
+  fPrintIntervalCmd->SetDefaultUnit("s");
+  fPrintIntervalCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrintIntervalCmd->SetToBeBroadcasted(false);
+
+  fFlushIntervalCmd = new G4UIcmdWithAnInteger("/B2/run/flushInterval",this);
+  fFlushIntervalCmd->SetGuidance("Histories per thread between merges of the tallies.");
+  fFlushIntervalCmd->SetParameterName("histories",false);
+  fFlushIntervalCmd->SetRange("histories>0");
+  fFlushIntervalCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fFlushIntervalCmd->SetToBeBroadcasted(false);
+
+  fSeedModeCmd = new G4UIcmdWithAString("/B2/run/seedMode",this);
+  fSeedModeCmd->SetGuidance("Seeding of the events:");
+  fSeedModeCmd->SetGuidance("  default: seeds drawn by the run manager from the master engine");
+  fSeedModeCmd->SetGuidance("  event:   seeds derived from the master seed and the event id,");
+  fSeedModeCmd->SetGuidance("           independent of the number of threads");
+  fSeedModeCmd->SetParameterName("mode",false);
+  fSeedModeCmd->SetCandidates("default event");
+  fSeedModeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fSeedModeCmd->SetToBeBroadcasted(false);
+
+  fMasterSeedCmd = new G4UIcmdWithAnInteger("/B2/run/masterSeed",this);
+  fMasterSeedCmd->SetGuidance("Master seed of the per-event seeding mode.");
+  fMasterSeedCmd->SetParameterName("seed",false);
+  fMasterSeedCmd->SetRange("seed>=0");
+  fMasterSeedCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMasterSeedCmd->SetToBeBroadcasted(false);
+
+  fReplayEventCmd = new G4UIcmdWithAnInteger("/B2/run/replayEvent",this);
+  fReplayEventCmd->SetGuidance("Simulate again the event with this id (per-event seeding only).");
+  fReplayEventCmd->SetParameterName("eventID",false);
+  fReplayEventCmd->SetRange("eventID>=0");
+  fReplayEventCmd->AvailableForStates(G4State_Idle);
+  fReplayEventCmd->SetToBeBroadcasted(false);
+
+  fBeamOnCmd = new G4UIcmdWithAnInteger("/B2/run/beamOn",this);
+  fBeamOnCmd->SetGuidance("Run nEvents for this configuration. With --shard i/n only the");
+  fBeamOnCmd->SetGuidance("events of shard i are processed, and if the checkpoint directory");
+  fBeamOnCmd->SetGuidance("holds an interrupted run only the remaining ones. Every resumed");
+  fBeamOnCmd->SetGuidance("segment numbers its events past nEvents times its index, and the");
+  fBeamOnCmd->SetGuidance("ids must stay below 2^31 (32-bit Evt column of the ntuple).");
+  fBeamOnCmd->SetParameterName("nEvents",false);
+  fBeamOnCmd->SetRange("nEvents>0");
+  fBeamOnCmd->AvailableForStates(G4State_Idle);
+  fBeamOnCmd->SetToBeBroadcasted(false);
+
+  fPrimariesCmd = new G4UIcmdWithAnInteger("/B2/run/primariesPerEvent",this);
+  fPrimariesCmd->SetGuidance("Protons generated per event, each one a history of the");
+  fPrimariesCmd->SetGuidance("tallies; /run/beamOn N then simulates N times as many protons.");
+  fPrimariesCmd->SetParameterName("nPrimaries",false);
+  fPrimariesCmd->SetRange("nPrimaries>0");
+  fPrimariesCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPrimariesCmd->SetToBeBroadcasted(false);
+
+  fPinningCmd = new G4UIcmdWithAString("/B2/run/pinning",this);
+  fPinningCmd->SetGuidance("Placement of the worker threads, applied when they start:");
+  fPinningCmd->SetGuidance("  none:    left to the operating system");
+  fPinningCmd->SetGuidance("  compact: one CPU per worker, in the order of the affinity mask");
+  fPinningCmd->SetGuidance("  numa:    one CPU per worker, alternating between NUMA nodes");
+  fPinningCmd->SetParameterName("mode",false);
+  fPinningCmd->SetCandidates("none compact numa");
+  fPinningCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPinningCmd->SetToBeBroadcasted(false);
+
+  fPhysicsTableCacheCmd = new G4UIcmdWithAString("/B2/run/physicsTableCache",this);
+  fPhysicsTableCacheCmd->SetGuidance("Directory where the physics tables are stored on the first");
+  fPhysicsTableCacheCmd->SetGuidance("run of a configuration and retrieved from by the following");
+  fPhysicsTableCacheCmd->SetGuidance("ones (none: always build them).");
+  fPhysicsTableCacheCmd->SetParameterName("path",false);
+  fPhysicsTableCacheCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fPhysicsTableCacheCmd->SetToBeBroadcasted(false);
+
+  fEarlyTerminationCmd = new G4UIcmdWithAString("/B2/run/earlyTermination",this);
+  fEarlyTerminationCmd->SetGuidance("End the events early once their tallies are final:");
+  fEarlyTerminationCmd->SetGuidance("  none:          follow every track");
+  fEarlyTerminationCmd->SetGuidance("  neutronsFirst: follow every track, the neutrons first");
+  fEarlyTerminationCmd->SetGuidance("  firstEntry:    track the neutrons first and stop once every");
+  fEarlyTerminationCmd->SetGuidance("                 primary has sent a neutron into every detector;");
+  fEarlyTerminationCmd->SetGuidance("                 per-hit histograms and ntuple rows are truncated");
+  fEarlyTerminationCmd->SetGuidance("The neutron-first order changes which neutron is the first to");
+  fEarlyTerminationCmd->SetGuidance("enter a detector: the tallies and E* spectra of neutronsFirst and");
+  fEarlyTerminationCmd->SetGuidance("firstEntry agree event by event, those of none only statistically.");
+  fEarlyTerminationCmd->SetParameterName("mode",false);
+  fEarlyTerminationCmd->SetCandidates("none neutronsFirst firstEntry");
+  fEarlyTerminationCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fEarlyTerminationCmd->SetToBeBroadcasted(false);
+
+  fCheckpointDirectory = new G4UIdirectory("/B2/checkpoint/");
+  fCheckpointDirectory->SetGuidance("Periodic checkpoints and resume of long runs");
+
+  fCheckpointDirCmd = new G4UIcmdWithAString("/B2/checkpoint/directory",this);
+  fCheckpointDirCmd->SetGuidance("Directory holding the checkpoint files.");
+  fCheckpointDirCmd->SetParameterName("path",false);
+  fCheckpointDirCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCheckpointDirCmd->SetToBeBroadcasted(false);
+
+  fCheckpointIntervalCmd = new G4UIcmdWithADoubleAndUnit("/B2/checkpoint/interval",this);
+  fCheckpointIntervalCmd->SetGuidance("Wall-clock interval between checkpoints (0 disables).");
+  fCheckpointIntervalCmd->SetParameterName("interval",false);
+  fCheckpointIntervalCmd->SetUnitCategory("Time");
+  fCheckpointIntervalCmd->SetDefaultUnit("s");
+  fCheckpointIntervalCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fCheckpointIntervalCmd->SetToBeBroadcasted(false);
+
+  fCheckpointBeamOnCmd = new G4UIcmdWithAnInteger("/B2/checkpoint/beamOn",this);
+  fCheckpointBeamOnCmd->SetGuidance("Former name of /B2/run/beamOn, kept for existing macros.");
+  fCheckpointBeamOnCmd->SetParameterName("nEvents",false);
+  fCheckpointBeamOnCmd->SetRange("nEvents>0");
+  fCheckpointBeamOnCmd->AvailableForStates(G4State_Idle);
+  fCheckpointBeamOnCmd->SetToBeBroadcasted(false);
+
+  fProfileDirectory = new G4UIdirectory("/B2/profile/");
+  fProfileDirectory->SetGuidance("Step time by volume, particle and process");
+
+  fProfileEnableCmd = new G4UIcmdWithABool("/B2/profile/enable",this);
+  fProfileEnableCmd->SetGuidance("Profile the steps of the following runs. The stepping");
+  fProfileEnableCmd->SetGuidance("action is always installed and returns at once while");
+  fProfileEnableCmd->SetGuidance("profiling is disabled.");
+  fProfileEnableCmd->SetParameterName("enable",true);
+  fProfileEnableCmd->SetDefaultValue(true);
+  fProfileEnableCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fProfileEnableCmd->SetToBeBroadcasted(false);
+
+  fProfileRowsCmd = new G4UIcmdWithAnInteger("/B2/profile/rows",this);
+  fProfileRowsCmd->SetGuidance("Entries of the profile printed at the end of a run;");
+  fProfileRowsCmd->SetGuidance("the CSV file holds all of them.");
+  fProfileRowsCmd->SetParameterName("rows",false);
+  fProfileRowsCmd->SetRange("rows>=0");
+  fProfileRowsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fProfileRowsCmd->SetToBeBroadcasted(false);
+
+  fMonitorDirectory = new G4UIdirectory("/B2/monitor/");
+  fMonitorDirectory->SetGuidance("Live view of a running simulation over local HTTP");
+
+  fMonitorPortCmd = new G4UIcmdWithAnInteger("/B2/monitor/port",this);
+  fMonitorPortCmd->SetGuidance("Serve /status, /h1 and /h1/<name> on 127.0.0.1:port");
+  fMonitorPortCmd->SetGuidance("(0 stops the monitor). POST /stop?token=<token>, with the");
+  fMonitorPortCmd->SetGuidance("token printed when the monitor starts, stops the run.");
+  fMonitorPortCmd->SetParameterName("port",false);
+  fMonitorPortCmd->SetRange("port>=0 && port<65536");
+  fMonitorPortCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMonitorPortCmd->SetToBeBroadcasted(false);
+
+  fMonitorIntervalCmd = new G4UIcmdWithADoubleAndUnit("/B2/monitor/interval",this);
+  fMonitorIntervalCmd->SetGuidance("Wall-clock interval between snapshots of each worker.");
+  fMonitorIntervalCmd->SetParameterName("interval",false);
+  fMonitorIntervalCmd->SetRange("interval>0.");
+  fMonitorIntervalCmd->SetUnitCategory("Time");
+  fMonitorIntervalCmd->SetDefaultUnit("s");
+  fMonitorIntervalCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMonitorIntervalCmd->SetToBeBroadcasted(false);
+
+  fSweepDirectory = new G4UIdirectory("/B2/sweep/");
+  fSweepDirectory->SetGuidance("Parameter sweep in processes forked after initialisation");
+
+  fSweepThicknessCmd = new G4UIcmdWithAString("/B2/sweep/moderatorThickness",this);
+  fSweepThicknessCmd->SetGuidance("Space separated moderator thicknesses in mm (0: no moderator).");
+  fSweepThicknessCmd->SetParameterName("thicknesses",false);
+  fSweepThicknessCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fSweepThicknessCmd->SetToBeBroadcasted(false);
+
+  fSweepMaterialCmd = new G4UIcmdWithAString("/B2/sweep/targetMaterial",this);
+  fSweepMaterialCmd->SetGuidance("Space separated target materials, combined with every thickness.");
+  fSweepMaterialCmd->SetParameterName("materials",false);
+  fSweepMaterialCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fSweepMaterialCmd->SetToBeBroadcasted(false);
+
+  fSweepProcessesCmd = new G4UIcmdWithAnInteger("/B2/sweep/processes",this);
+  fSweepProcessesCmd->SetGuidance("Sweep points run at the same time (0: available cores).");
+  fSweepProcessesCmd->SetParameterName("processes",false);
+  fSweepProcessesCmd->SetRange("processes>=0");
+  fSweepProcessesCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fSweepProcessesCmd->SetToBeBroadcasted(false);
+
+  fSweepBeamOnCmd = new G4UIcmdWithAnInteger("/B2/sweep/beamOn",this);
+  fSweepBeamOnCmd->SetGuidance("Build the physics tables, then run nEvents at every sweep point");
+  fSweepBeamOnCmd->SetGuidance("in a forked child process (serial run manager only).");
+  fSweepBeamOnCmd->SetParameterName("nEvents",false);
+  fSweepBeamOnCmd->SetRange("nEvents>0");
+  fSweepBeamOnCmd->AvailableForStates(G4State_Idle);
+  fSweepBeamOnCmd->SetToBeBroadcasted(false);
+
+  fBeamDirectory = new G4UIdirectory("/B2/beam/");
+  fBeamDirectory->SetGuidance("Transverse profile of the proton beam spot");
+
+  fBeamProfileCmd = new G4UIcmdWithAString("/B2/beam/profile",this);
+  fBeamProfileCmd->SetGuidance("Shape of the beam spot:");
+  fBeamProfileCmd->SetGuidance("  radial: radius uniform up to /B2/beam/radius (denser at the centre)");
+  fBeamProfileCmd->SetGuidance("  disc:   uniform over the disc of /B2/beam/radius");
+  fBeamProfileCmd->SetGuidance("  gauss:  round Gaussian of /B2/beam/sigma");
+  fBeamProfileCmd->SetGuidance("  map:    measured map loaded with /B2/beam/map");
+  fBeamProfileCmd->SetParameterName("profile",false);
+  fBeamProfileCmd->SetCandidates("radial disc gauss map");
+  fBeamProfileCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBeamProfileCmd->SetToBeBroadcasted(false);
+
+  fBeamRadiusCmd = new G4UIcmdWithADoubleAndUnit("/B2/beam/radius",this);
+  fBeamRadiusCmd->SetGuidance("Radius of the radial and disc profiles.");
+  fBeamRadiusCmd->SetParameterName("radius",false);
+  fBeamRadiusCmd->SetRange("radius>0.");
+  fBeamRadiusCmd->SetUnitCategory("Length");
+  fBeamRadiusCmd->SetDefaultUnit("mm");
+  fBeamRadiusCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBeamRadiusCmd->SetToBeBroadcasted(false);
+
+  fBeamSigmaCmd = new G4UIcmdWithADoubleAndUnit("/B2/beam/sigma",this);
+  fBeamSigmaCmd->SetGuidance("Standard deviation of the gauss profile in x and y.");
+  fBeamSigmaCmd->SetParameterName("sigma",false);
+  fBeamSigmaCmd->SetRange("sigma>0.");
+  fBeamSigmaCmd->SetUnitCategory("Length");
+  fBeamSigmaCmd->SetDefaultUnit("mm");
+  fBeamSigmaCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBeamSigmaCmd->SetToBeBroadcasted(false);
+
+  fBeamMapCmd = new G4UIcmdWithAString("/B2/beam/map",this);
+  fBeamMapCmd->SetGuidance("Load a measured beam map and select the map profile. The file");
+  fBeamMapCmd->SetGuidance("holds \"xmin xmax ymin ymax\" in mm, then one row of cell weights");
+  fBeamMapCmd->SetGuidance("per y bin from ymin upwards; '#' starts a comment line.");
+  fBeamMapCmd->SetParameterName("file",false);
+  fBeamMapCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBeamMapCmd->SetToBeBroadcasted(false);
+
+  fBeamSamplingCmd = new G4UIcmdWithAString("/B2/beam/sampling",this);
+  fBeamSamplingCmd->SetGuidance("Sampling of the beam spot:");
+  fBeamSamplingCmd->SetGuidance("  pseudo:     random engine of the thread");
+  fBeamSamplingCmd->SetGuidance("  stratified: one jittered cell of a strata x strata grid per proton");
+  fBeamSamplingCmd->SetGuidance("  sobol:      Owen-scrambled Sobol points");
+  fBeamSamplingCmd->SetGuidance("stratified and sobol are keyed on the global event id and the");
+  fBeamSamplingCmd->SetGuidance("master seed, independent of the threads and shards.");
+  fBeamSamplingCmd->SetParameterName("sampling",false);
+  fBeamSamplingCmd->SetCandidates("pseudo stratified sobol");
+  fBeamSamplingCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBeamSamplingCmd->SetToBeBroadcasted(false);
+
+  fBeamStrataCmd = new G4UIcmdWithAnInteger("/B2/beam/strata",this);
+  fBeamStrataCmd->SetGuidance("Grid cells per axis of the stratified sampling.");
+  fBeamStrataCmd->SetParameterName("strata",false);
+  fBeamStrataCmd->SetRange("strata>0");
+  fBeamStrataCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fBeamStrataCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunMessenger::~RunMessenger()
+{
+  delete fTargetRelErrorCmd;
+  delete fStopTalliesCmd;
+  delete fMaxWallTimeCmd;
+  delete fPrintIntervalCmd;
+  delete fFlushIntervalCmd;
+  delete fSeedModeCmd;
+  delete fMasterSeedCmd;
+  delete fReplayEventCmd;
+  delete fBeamOnCmd;
+  delete fPrimariesCmd;
+  delete fPinningCmd;
+  delete fPhysicsTableCacheCmd;
+  delete fEarlyTerminationCmd;
+  delete fCheckpointDirCmd;
+  delete fCheckpointIntervalCmd;
+  delete fCheckpointBeamOnCmd;
+  delete fProfileEnableCmd;
+  delete fProfileRowsCmd;
+  delete fMonitorPortCmd;
+  delete fMonitorIntervalCmd;
+  delete fSweepThicknessCmd;
+  delete fSweepMaterialCmd;
+  delete fSweepProcessesCmd;
+  delete fSweepBeamOnCmd;
+  delete fBeamProfileCmd;
+  delete fBeamRadiusCmd;
+  delete fBeamSigmaCmd;
+  delete fBeamMapCmd;
+  delete fBeamSamplingCmd;
+  delete fBeamStrataCmd;
+  delete fRunDirectory;
+  delete fCheckpointDirectory;
+  delete fProfileDirectory;
+  delete fMonitorDirectory;
+  delete fSweepDirectory;
+  delete fBeamDirectory;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
+{
+  auto tallyManager = TallyManager::Instance();
+
+  if( command == fTargetRelErrorCmd )
+   { tallyManager->SetTargetRelativeError(fTargetRelErrorCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fStopTalliesCmd )
+   { tallyManager->SetStopTallies(newValue);}
+
+  if( command == fMaxWallTimeCmd )
+   { tallyManager->SetMaxWallTime(fMaxWallTimeCmd->GetNewDoubleValue(newValue) / s);}
+
+  if( command == fPrintIntervalCmd ) {
+    G4double interval = fPrintIntervalCmd->GetNewDoubleValue(newValue) / s;
+    tallyManager->SetPrintInterval(interval);
+    RunStatistics::Instance()->SetPrintInterval(interval);
+  }
+
+  if( command == fFlushIntervalCmd )
+   { tallyManager->SetFlushInterval(fFlushIntervalCmd->GetNewIntValue(newValue));}
+
+  auto eventSeeder = EventSeeder::Instance();
+
+  if( command == fSeedModeCmd ) {
+    eventSeeder->SetMode(newValue == "event" ? EventSeeder::Mode::PerEvent
+                                             : EventSeeder::Mode::Default);
+  }
+
+  if( command == fMasterSeedCmd )
+   { eventSeeder->SetMasterSeed(fMasterSeedCmd->GetNewIntValue(newValue));}
+
+  if( command == fReplayEventCmd )
+   { eventSeeder->ReplayEvent(fReplayEventCmd->GetNewIntValue(newValue));}
+
+  if( command == fBeamOnCmd )
+   { eventSeeder->BeamOn(fBeamOnCmd->GetNewIntValue(newValue));}
+
+  if( command == fCheckpointBeamOnCmd )
+   { eventSeeder->BeamOn(fCheckpointBeamOnCmd->GetNewIntValue(newValue));}
+
+  if( command == fPrimariesCmd )
+   { PrimaryGeneratorAction::SetPrimariesPerEvent(fPrimariesCmd->GetNewIntValue(newValue));}
+
+  if( command == fPinningCmd ) {
+    auto mode = ThreadPlacement::Mode::None;
+    if (newValue == "compact") mode = ThreadPlacement::Mode::Compact;
+    if (newValue == "numa") mode = ThreadPlacement::Mode::Numa;
+    ThreadPlacement::Instance()->SetMode(mode);
+  }
+
+  if( command == fPhysicsTableCacheCmd )
+   { PhysicsTableCache::Instance()->SetDirectory(newValue == "none" ? "" : newValue);}
+
+  if( command == fEarlyTerminationCmd ) {
+    auto mode = EventTermination::Mode::None;
+    if (newValue == "neutronsFirst") mode = EventTermination::Mode::NeutronsFirst;
+    if (newValue == "firstEntry") mode = EventTermination::Mode::FirstEntry;
+    EventTermination::SetMode(mode);
+  }
+
+  auto checkpointManager = CheckpointManager::Instance();
+
+  if( command == fCheckpointDirCmd )
+   { checkpointManager->SetDirectory(newValue);}
+
+  if( command == fCheckpointIntervalCmd )
+   { checkpointManager->SetInterval(fCheckpointIntervalCmd->GetNewDoubleValue(newValue) / s);}
+
+  auto profiler = SteppingProfiler::Instance();
+
+  if( command == fProfileEnableCmd )
+   { profiler->SetEnabled(fProfileEnableCmd->GetNewBoolValue(newValue));}
+
+  if( command == fProfileRowsCmd )
+   { profiler->SetPrintRows(fProfileRowsCmd->GetNewIntValue(newValue));}
+
+  if( command == fMonitorPortCmd )
+   { Monitor::Instance()->SetPort(fMonitorPortCmd->GetNewIntValue(newValue));}
+
+  if( command == fMonitorIntervalCmd )
+   { Monitor::Instance()->SetInterval(fMonitorIntervalCmd->GetNewDoubleValue(newValue) / s);}
+
+  auto sweepRunner = SweepRunner::Instance();
+
+  if( command == fSweepThicknessCmd )
+   { sweepRunner->SetModeratorThicknesses(newValue);}
+
+  if( command == fSweepMaterialCmd )
+   { sweepRunner->SetTargetMaterials(newValue);}
+
+  if( command == fSweepProcessesCmd )
+   { sweepRunner->SetProcesses(fSweepProcessesCmd->GetNewIntValue(newValue));}
+
+  if( command == fSweepBeamOnCmd )
+   { sweepRunner->BeamOn(fSweepBeamOnCmd->GetNewIntValue(newValue));}
+
+  auto beamProfile = BeamProfile::Instance();
+
+  if( command == fBeamProfileCmd ) {
+    auto shape = BeamProfile::Shape::Radial;
+    if (newValue == "disc") shape = BeamProfile::Shape::Disc;
+    if (newValue == "gauss") shape = BeamProfile::Shape::Gauss;
+    if (newValue == "map") shape = BeamProfile::Shape::Map;
+    beamProfile->SetShape(shape);
+  }
+
+  if( command == fBeamRadiusCmd )
+   { beamProfile->SetRadius(fBeamRadiusCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fBeamSigmaCmd )
+   { beamProfile->SetSigma(fBeamSigmaCmd->GetNewDoubleValue(newValue));}
+
+  if( command == fBeamMapCmd ) {
+    if (beamProfile->LoadMap(newValue)) beamProfile->SetShape(BeamProfile::Shape::Map);
+  }
+
+  if( command == fBeamSamplingCmd ) {
+    auto sampling = BeamProfile::Sampling::Pseudo;
+    if (newValue == "stratified") sampling = BeamProfile::Sampling::Stratified;
+    if (newValue == "sobol") sampling = BeamProfile::Sampling::Sobol;
+    beamProfile->SetSampling(sampling);
+  }
+
+  if( command == fBeamStrataCmd )
+   { beamProfile->SetStrata(fBeamStrataCmd->GetNewIntValue(newValue));}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
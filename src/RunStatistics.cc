@@ -0,0 +1,418 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/RunStatistics.cc
+/// \brief Implementation of the B2::RunStatistics class
+
+#include "RunStatistics.hh"
+#include "DetectorConstruction.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "ThreadPlacement.hh"
+
+#include "G4AutoLock.hh"
+#include "G4Material.hh"
+#include "G4RunManager.hh"
+#include "G4TaskRunManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+
+namespace B2
+{
+
+G4ThreadLocal RunStatistics::ThreadCounters* RunStatistics::fgThreadCounters = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunStatistics* RunStatistics::Instance()
+{
+  static RunStatistics instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::BeginOfRun()
+{
+  auto counters = GetThreadCounters();
+  counters->counts = Counts();
+  counters->reported = Counts();
+  counters->start = Clock::now();
+  counters->lastEventEnd = counters->start;
+  counters->cpuStart = GetThreadCpuTime();
+  counters->busy = 0.;
+  counters->maxEvent = 0.;
+  std::fill(counters->latency.begin(), counters->latency.end(), 0);
+
+  // The master begins its run before the workers start theirs
+  if ( ! G4Threading::IsMasterThread() ) return;
+
+  G4AutoLock lock(&fMutex);
+  fRunStart = counters->start;
+  fRecords.clear();
+  fLatency.assign(kLatencyBins, 0);
+  fMaxEventTime = 0.;
+  fProgressEvents = 0;
+  fProgressSteps = 0;
+  fNextPrint = fPrintInterval;
+  fLastPrintTime = 0.;
+  fLastPrintEvents = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::BeginOfEvent()
+{
+  GetThreadCounters()->eventStart = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::EndOfTrack(G4int nSteps)
+{
+  auto counters = GetThreadCounters();
+  ++counters->counts.tracks;
+  counters->counts.steps += nSteps;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::EndOfEvent(G4long nHits)
+{
+  auto counters = GetThreadCounters();
+  counters->lastEventEnd = Clock::now();
+  std::chrono::duration<G4double> elapsed = counters->lastEventEnd - counters->eventStart;
+  G4double seconds = elapsed.count();
+
+  ++counters->counts.events;
+  counters->counts.hits += nHits;
+  counters->busy += seconds;
+  counters->maxEvent = std::max(counters->maxEvent, seconds);
+
+  std::size_t bin = 0;
+  if (seconds >= 1.e-6) bin = std::size_t(std::log2(seconds * 1.e6)) + 1;
+  ++counters->latency[std::min(bin, kLatencyBins - 1)];
+
+  if (counters->counts.events - counters->reported.events >= kProgressBatch) {
+    ReportProgress(counters);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::TerminatedEvent(G4long skippedTracks)
+{
+  auto counters = GetThreadCounters();
+  ++counters->counts.terminated;
+  counters->counts.skipped += skippedTracks;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::EndOfRun()
+{
+  auto counters = GetThreadCounters();
+  std::chrono::duration<G4double> elapsed = Clock::now() - counters->start;
+
+  // The master of a multi-threaded run processes no events itself
+  G4bool isMaster = G4Threading::IsMasterThread();
+  if ( ! isMaster || ! G4Threading::IsMultithreadedApplication() ) {
+    ThreadRecord record;
+    record.threadId = isMaster ? 0 : G4Threading::G4GetThreadId();
+    record.cpu = ThreadPlacement::GetCurrentCpu();
+    record.counts = counters->counts;
+    record.seconds = elapsed.count();
+    record.busy = counters->busy;
+    G4double cpuEnd = GetThreadCpuTime();
+    record.cpuTime = cpuEnd >= 0. ? cpuEnd - counters->cpuStart : -1.;
+
+    G4AutoLock lock(&fMutex);
+    if (counters->counts.events > 0) {
+      std::chrono::duration<G4double> finish = counters->lastEventEnd - fRunStart;
+      record.finish = finish.count();
+    }
+    fRecords.push_back(record);
+    for (std::size_t i = 0; i < kLatencyBins; ++i) fLatency[i] += counters->latency[i];
+    fMaxEventTime = std::max(fMaxEventTime, counters->maxEvent);
+  }
+
+  // Workers have ended their run by the time the master gets here
+  if (isMaster) {
+    fWallTime = elapsed.count();
+    std::sort(fRecords.begin(), fRecords.end(),
+              [](const ThreadRecord& a, const ThreadRecord& b) { return a.threadId < b.threadId; });
+    Print();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunStatistics::ThreadCounters* RunStatistics::GetThreadCounters()
+{
+  if ( ! fgThreadCounters ) fgThreadCounters = new ThreadCounters;
+  return fgThreadCounters;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::ReportProgress(ThreadCounters* counters)
+{
+  fProgressEvents += counters->counts.events - counters->reported.events;
+  fProgressSteps += counters->counts.steps - counters->reported.steps;
+  counters->reported = counters->counts;
+
+  if (fPrintInterval <= 0.) return;
+
+  // Only the thread that moves the print time forward prints
+  std::chrono::duration<G4double> now = Clock::now() - fRunStart;
+  G4double next = fNextPrint.load();
+  if (now.count() < next) return;
+  if ( ! fNextPrint.compare_exchange_strong(next, now.count() + fPrintInterval) ) return;
+
+  G4AutoLock lock(&fMutex);
+  G4long events = fProgressEvents;
+  G4long steps = fProgressSteps;
+  G4double interval = now.count() - fLastPrintTime;
+  G4double rate = interval > 0. ? (events - fLastPrintEvents) / interval : 0.;
+  G4cout << "--> Progress: " << G4long(now.count()) << " s, " << events << " events, "
+         << G4long(rate) << " events/s, " << (events > 0 ? G4double(steps) / events : 0.)
+         << " steps/event" << G4endl;
+  fLastPrintTime = now.count();
+  fLastPrintEvents = events;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double RunStatistics::GetThreadCpuTime()
+{
+#ifdef CLOCK_THREAD_CPUTIME_ID
+  timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) == 0) {
+    return time.tv_sec + 1.e-9 * time.tv_nsec;
+  }
+#endif
+  return -1.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RunStatistics::Counts RunStatistics::GetTotals() const
+{
+  Counts totals;
+  for (const auto& record : fRecords) {
+    totals.events += record.counts.events;
+    totals.tracks += record.counts.tracks;
+    totals.steps += record.counts.steps;
+    totals.hits += record.counts.hits;
+    totals.terminated += record.counts.terminated;
+    totals.skipped += record.counts.skipped;
+  }
+  return totals;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double RunStatistics::GetIdleFraction() const
+{
+  if (fWallTime <= 0. || fRecords.empty()) return 0.;
+  G4double idle = 0.;
+  for (const auto& record : fRecords) idle += fWallTime - record.busy;
+  return idle / (fWallTime * fRecords.size());
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double RunStatistics::GetTail() const
+{
+  G4double firstFinish = -1., lastFinish = -1.;
+  for (const auto& record : fRecords) {
+    if (record.finish < 0.) continue;
+    if (firstFinish < 0. || record.finish < firstFinish) firstFinish = record.finish;
+    lastFinish = std::max(lastFinish, record.finish);
+  }
+  return lastFinish > 0. ? lastFinish - firstFinish : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double RunStatistics::GetLatencyPercentile(G4double fraction) const
+{
+  G4long total = 0;
+  for (G4long count : fLatency) total += count;
+  if (total == 0) return 0.;
+
+  // Upper edge of the bin holding the percentile, capped by the maximum
+  G4long threshold = G4long(std::ceil(fraction * total));
+  G4long cumulative = 0;
+  for (std::size_t i = 0; i < fLatency.size(); ++i) {
+    cumulative += fLatency[i];
+    if (cumulative >= threshold) return std::min(std::ldexp(1.e-6, G4int(i)), fMaxEventTime);
+  }
+  return fMaxEventTime;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::Print() const
+{
+  Counts totals = GetTotals();
+  G4double rate = fWallTime > 0. ? totals.events / fWallTime : 0.;
+  auto precision = G4cout.precision();
+
+  G4cout << G4endl
+         << "--------------------Per-thread throughput--------------------" << G4endl
+         << std::setw(8) << "thread" << std::setw(6) << "cpu" << std::setw(12) << "events"
+         << std::setw(12) << "events/s" << std::setw(10) << "busy [s]"
+         << std::setw(10) << "idle [s]" << std::setw(10) << "cpu [s]"
+         << std::setw(12) << "finish [s]" << G4endl
+         << std::fixed << std::setprecision(2);
+  for (const auto& record : fRecords) {
+    G4double threadRate = record.seconds > 0. ? record.counts.events / record.seconds : 0.;
+    G4cout << std::setw(8) << record.threadId << std::setw(6) << record.cpu
+           << std::setw(12) << record.counts.events << std::setw(12) << threadRate
+           << std::setw(10) << record.busy << std::setw(10) << fWallTime - record.busy
+           << std::setw(10) << record.cpuTime << std::setw(12) << record.finish << G4endl;
+  }
+  G4cout << std::setw(8) << "total" << std::setw(6) << "" << std::setw(12) << totals.events
+         << std::setw(12) << rate << G4endl
+         << "Throughput: " << rate << " events/s on " << fRecords.size() << " threads"
+         << G4endl
+         << "Wall time: " << fWallTime << " s, idle " << 100. * GetIdleFraction()
+         << " %, end-of-run tail " << GetTail() << " s" << G4endl
+         << "Per event: "
+         << (totals.events > 0 ? G4double(totals.tracks) / totals.events : 0.) << " tracks, "
+         << (totals.events > 0 ? G4double(totals.steps) / totals.events : 0.) << " steps, "
+         << (totals.events > 0 ? G4double(totals.hits) / totals.events : 0.) << " hits"
+         << G4endl;
+  if (totals.terminated > 0) {
+    G4cout << "Early termination: " << totals.terminated << " events ("
+           << 100. * totals.terminated / totals.events << " %), "
+           << totals.skipped << " tracks skipped" << G4endl;
+  }
+  G4cout << std::defaultfloat << std::setprecision(4)
+         << "Event time: p50 " << GetLatencyPercentile(0.5)
+         << " s, p99 " << GetLatencyPercentile(0.99)
+         << " s, p99.9 " << GetLatencyPercentile(0.999)
+         << " s, max " << fMaxEventTime << " s" << G4endl
+         << std::setprecision(precision)
+         << "-------------------------------------------------------------" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RunStatistics::Write(const G4String& fileName, G4int runID) const
+{
+  std::ofstream out(fileName);
+  if ( ! out ) {
+    G4cout << "-->  WARNING from RunStatistics : cannot write " << fileName << G4endl;
+    return;
+  }
+
+  auto runManager = G4RunManager::GetRunManager();
+  G4String runManagerType = "mt";
+  if (runManager->GetRunManagerType() == G4RunManager::sequentialRM) {
+    runManagerType = "serial";
+  }
+  else if (dynamic_cast<G4TaskRunManager*>(runManager) != nullptr) {
+    runManagerType = "tasking";
+  }
+
+  G4String pinning = "none";
+  auto pinningMode = ThreadPlacement::Instance()->GetMode();
+  if (pinningMode == ThreadPlacement::Mode::Compact) pinning = "compact";
+  if (pinningMode == ThreadPlacement::Mode::Numa) pinning = "numa";
+
+  char timestamp[32] = "";
+  std::time_t now = std::time(nullptr);
+  std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+  Counts totals = GetTotals();
+  G4double perEvent = totals.events > 0 ? 1. / totals.events : 0.;
+  G4double cpuTime = 0.;
+  for (const auto& record : fRecords) cpuTime += std::max(record.cpuTime, 0.);
+
+  out << std::setprecision(6)
+      << "{\n"
+      << "  \"run\": " << runID << ",\n"
+      << "  \"timestamp\": \"" << timestamp << "\",\n"
+      << "  \"runManager\": \"" << runManagerType << "\",\n"
+      << "  \"threads\": " << runManager->GetNumberOfThreads() << ",\n"
+      << "  \"pinning\": \"" << pinning << "\",\n"
+      << "  \"primariesPerEvent\": " << PrimaryGeneratorAction::GetPrimariesPerEvent() << ",\n";
+
+  auto detector = dynamic_cast<const B2b::DetectorConstruction*>(
+    runManager->GetUserDetectorConstruction());
+  if (detector != nullptr) {
+    out << "  \"geometry\": {\n"
+        << "    \"moderatorThickness_mm\": " << detector->GetModeratorThickness() / mm << ",\n"
+        << "    \"moderatorMaterial\": \"" << detector->GetModeratorMaterial()->GetName() << "\",\n"
+        << "    \"targetMaterial\": \"" << detector->GetTargetMaterial()->GetName() << "\"\n"
+        << "  },\n";
+  }
+
+  out << "  \"wallTime_s\": " << fWallTime << ",\n"
+      << "  \"cpuTime_s\": " << cpuTime << ",\n"
+      << "  \"events\": " << totals.events << ",\n"
+      << "  \"tracks\": " << totals.tracks << ",\n"
+      << "  \"steps\": " << totals.steps << ",\n"
+      << "  \"hits\": " << totals.hits << ",\n"
+      << "  \"eventsPerSecond\": " << (fWallTime > 0. ? totals.events / fWallTime : 0.) << ",\n"
+      << "  \"tracksPerEvent\": " << totals.tracks * perEvent << ",\n"
+      << "  \"stepsPerEvent\": " << totals.steps * perEvent << ",\n"
+      << "  \"hitsPerEvent\": " << totals.hits * perEvent << ",\n"
+      << "  \"terminatedEvents\": " << totals.terminated << ",\n"
+      << "  \"skippedTracks\": " << totals.skipped << ",\n"
+      << "  \"idleFraction\": " << GetIdleFraction() << ",\n"
+      << "  \"tail_s\": " << GetTail() << ",\n"
+      << "  \"eventTime_s\": {\"p50\": " << GetLatencyPercentile(0.5)
+      << ", \"p99\": " << GetLatencyPercentile(0.99)
+      << ", \"p999\": " << GetLatencyPercentile(0.999)
+      << ", \"max\": " << fMaxEventTime << "},\n"
+      << "  \"perThread\": [";
+  for (std::size_t i = 0; i < fRecords.size(); ++i) {
+    const auto& record = fRecords[i];
+    out << (i ? "," : "") << "\n    {\"thread\": " << record.threadId
+        << ", \"cpu\": " << record.cpu
+        << ", \"events\": " << record.counts.events
+        << ", \"tracks\": " << record.counts.tracks
+        << ", \"steps\": " << record.counts.steps
+        << ", \"hits\": " << record.counts.hits
+        << ", \"wallTime_s\": " << record.seconds
+        << ", \"cpuTime_s\": " << record.cpuTime
+        << ", \"busy_s\": " << record.busy
+        << ", \"finish_s\": " << record.finish << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
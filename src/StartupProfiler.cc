@@ -0,0 +1,179 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/StartupProfiler.cc
+/// \brief Implementation of the B2::StartupProfiler class
+
+#include "StartupProfiler.hh"
+
+#include "G4AutoLock.hh"
+#include "G4StateManager.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <iomanip>
+
+namespace B2
+{
+
+G4ThreadLocal StartupProfiler::Clock::time_point* StartupProfiler::fgWorkerStart = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StartupProfiler* StartupProfiler::Instance()
+{
+  // Not a static object: the G4StateManager deletes its dependents
+  static auto instance = new StartupProfiler;
+  return instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double StartupProfiler::Seconds(Clock::time_point start)
+{
+  return std::chrono::duration<G4double>(Clock::now() - start).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::StartPhase(const G4String& name)
+{
+  fPhases.push_back({name, 0., ""});
+  fPhaseStart = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::StopPhase(const G4String& note)
+{
+  if (fPhases.empty()) return;
+  fPhases.back().seconds = Seconds(fPhaseStart);
+  fPhases.back().note = note;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::BeginWorker()
+{
+  if ( ! fgWorkerStart ) fgWorkerStart = new Clock::time_point;
+  *fgWorkerStart = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::BeginOfRun()
+{
+  // Only the first run of a worker completes its initialisation
+  if ( ! fgWorkerStart ) return;
+  G4double seconds = Seconds(*fgWorkerStart);
+  delete fgWorkerStart;
+  fgWorkerStart = nullptr;
+
+  G4AutoLock lock(&fMutex);
+  ++fWorkers;
+  fSlowestWorker = std::max(fSlowestWorker, seconds);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::EndOfRun()
+{
+  if ( ! G4Threading::IsMasterThread() || fRunPrinted ) return;
+  fRunPrinted = true;
+
+  auto precision = G4cout.precision();
+  G4cout << G4endl
+         << "--------------------Startup of the first run-----------------" << G4endl
+         << std::fixed << std::setprecision(3);
+  if (fPhysicsTables >= 0.) {
+    G4cout << std::left << std::setw(28) << "physics tables" << std::right
+           << std::setw(10) << fPhysicsTables << " s" << G4endl;
+  }
+  G4AutoLock lock(&fMutex);
+  if (fWorkers > 0) {
+    G4cout << std::left << std::setw(28) << "worker initialisation" << std::right
+           << std::setw(10) << fSlowestWorker << " s  slowest of " << fWorkers
+           << " threads" << G4endl;
+  }
+  G4cout << std::defaultfloat << std::setprecision(precision)
+         << "-------------------------------------------------------------" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool StartupProfiler::Notify(G4ApplicationState requestedState)
+{
+  // Called before the state changes
+  auto current = G4StateManager::GetStateManager()->GetCurrentState();
+
+  if (requestedState == G4State_Init && current != G4State_Init) {
+    fInPeriod = true;
+    fPhases.clear();
+    fPeriodStart = Clock::now();
+  }
+  else if (fInPeriod && current == G4State_Init) {
+    fInPeriod = false;
+    G4double seconds = Seconds(fPeriodStart);
+    // Geometry is only built by /run/initialize (or a reinitialisation),
+    // the first period without it is the run building the physics tables
+    if ( ! fPhases.empty() ) {
+      PrintInitialization(seconds);
+    }
+    else if (fPhysicsTables < 0.) {
+      fPhysicsTables = seconds;
+    }
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StartupProfiler::PrintInitialization(G4double seconds) const
+{
+  G4double physics = seconds;
+  for (const auto& phase : fPhases) physics -= phase.seconds;
+
+  auto precision = G4cout.precision();
+  G4cout << G4endl
+         << "--------------------Startup of /run/initialize---------------" << G4endl
+         << std::fixed << std::setprecision(3);
+  for (const auto& phase : fPhases) {
+    G4cout << std::left << std::setw(28) << phase.name << std::right
+           << std::setw(10) << phase.seconds << " s";
+    if ( ! phase.note.empty() ) G4cout << "  " << phase.note;
+    G4cout << G4endl;
+  }
+  G4cout << std::left << std::setw(28) << "physics list and kernel" << std::right
+         << std::setw(10) << std::max(physics, 0.) << " s" << G4endl
+         << std::left << std::setw(28) << "total" << std::right
+         << std::setw(10) << seconds << " s" << G4endl
+         << std::defaultfloat << std::setprecision(precision)
+         << "-------------------------------------------------------------" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,207 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/SteppingProfiler.cc
+/// \brief Implementation of the B2::SteppingProfiler class
+
+#include "SteppingProfiler.hh"
+
+#include "G4AutoLock.hh"
+#include "G4LogicalVolume.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Step.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4VProcess.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+namespace B2
+{
+
+G4ThreadLocal SteppingProfiler::ThreadProfile* SteppingProfiler::fgThreadProfile = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SteppingProfiler* SteppingProfiler::Instance()
+{
+  static SteppingProfiler instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::size_t SteppingProfiler::KeyHash::operator()(const Key& key) const
+{
+  std::size_t hash = std::hash<const void*>()(std::get<0>(key));
+  hash = hash * 31 + std::hash<const void*>()(std::get<1>(key));
+  hash = hash * 31 + std::hash<const void*>()(std::get<2>(key));
+  return hash;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::BeginOfRun()
+{
+  if (G4Threading::IsMasterThread()) {
+    G4AutoLock lock(&fMutex);
+    fMerged.clear();
+  }
+  if ( ! fEnabled ) return;
+
+  auto profile = GetThreadProfile();
+  profile->entries.clear();
+  profile->lastEntry = nullptr;
+  profile->last = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::StartTrack()
+{
+  GetThreadProfile()->last = Clock::now();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::Step(const G4Step* step)
+{
+  auto profile = GetThreadProfile();
+  Clock::time_point now = Clock::now();
+  std::chrono::duration<G4double> elapsed = now - profile->last;
+  profile->last = now;
+
+  const G4StepPoint* preStepPoint = step->GetPreStepPoint();
+  Key key(preStepPoint->GetPhysicalVolume()->GetLogicalVolume(),
+          step->GetTrack()->GetParticleDefinition(),
+          step->GetPostStepPoint()->GetProcessDefinedStep());
+
+  if (profile->lastEntry == nullptr || key != profile->lastKey) {
+    profile->lastKey = key;
+    profile->lastEntry = &profile->entries[key];
+  }
+  ++profile->lastEntry->steps;
+  profile->lastEntry->seconds += elapsed.count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::EndOfRun()
+{
+  if (fEnabled && fgThreadProfile != nullptr) {
+    // Processes are per thread, so tables can only be merged by name
+    G4AutoLock lock(&fMutex);
+    for (const auto& [key, entry] : fgThreadProfile->entries) {
+      auto volume = std::get<0>(key);
+      auto particle = std::get<1>(key);
+      auto process = std::get<2>(key);
+      NameKey name(volume ? volume->GetName() : G4String("none"),
+                   particle ? particle->GetParticleName() : G4String("none"),
+                   process ? process->GetProcessName() : G4String("none"));
+      Entry& merged = fMerged[name];
+      merged.steps += entry.steps;
+      merged.seconds += entry.seconds;
+    }
+    fgThreadProfile->entries.clear();
+    fgThreadProfile->lastEntry = nullptr;
+  }
+
+  // Workers have ended their run by the time the master gets here
+  if (G4Threading::IsMasterThread() && ! fMerged.empty()) Print();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SteppingProfiler::ThreadProfile* SteppingProfiler::GetThreadProfile()
+{
+  if ( ! fgThreadProfile ) fgThreadProfile = new ThreadProfile;
+  return fgThreadProfile;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::Print() const
+{
+  std::vector<std::pair<NameKey, Entry>> rows(fMerged.begin(), fMerged.end());
+  std::sort(rows.begin(), rows.end(),
+            [](const auto& a, const auto& b) { return a.second.seconds > b.second.seconds; });
+
+  G4long steps = 0;
+  G4double seconds = 0.;
+  for (const auto& row : rows) {
+    steps += row.second.steps;
+    seconds += row.second.seconds;
+  }
+  auto precision = G4cout.precision();
+
+  G4cout << G4endl
+         << "--------------------Stepping profile-------------------------" << G4endl
+         << std::left << std::setw(16) << "volume" << std::setw(12) << "particle"
+         << std::setw(20) << "process" << std::right << std::setw(14) << "steps"
+         << std::setw(12) << "time [s]" << std::setw(8) << "time %"
+         << std::setw(10) << "ns/step" << G4endl
+         << std::fixed;
+  std::size_t nRows = std::min(rows.size(), std::size_t(std::max(fPrintRows, 0)));
+  for (std::size_t i = 0; i < nRows; ++i) {
+    const auto& [name, entry] = rows[i];
+    G4cout << std::left << std::setw(16) << std::get<0>(name) << std::setw(12)
+           << std::get<1>(name) << std::setw(20) << std::get<2>(name) << std::right
+           << std::setw(14) << entry.steps << std::setprecision(2)
+           << std::setw(12) << entry.seconds
+           << std::setw(8) << (seconds > 0. ? 100. * entry.seconds / seconds : 0.)
+           << std::setprecision(0) << std::setw(10)
+           << (entry.steps > 0 ? 1.e9 * entry.seconds / entry.steps : 0.) << G4endl;
+  }
+  G4cout << std::left << std::setw(48) << "total" << std::right << std::setw(14) << steps
+         << std::setprecision(2) << std::setw(12) << seconds << G4endl
+         << std::defaultfloat << std::setprecision(precision)
+         << "-------------------------------------------------------------" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SteppingProfiler::Write(const G4String& fileName) const
+{
+  if (fMerged.empty()) return;
+
+  std::ofstream out(fileName);
+  if ( ! out ) {
+    G4cout << "-->  WARNING from SteppingProfiler : cannot write " << fileName << G4endl;
+    return;
+  }
+  out << "volume,particle,process,steps,seconds\n";
+  for (const auto& [name, entry] : fMerged) {
+    out << std::get<0>(name) << "," << std::get<1>(name) << "," << std::get<2>(name) << ","
+        << entry.steps << "," << entry.seconds << "\n";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
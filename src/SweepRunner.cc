@@ -0,0 +1,267 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/SweepRunner.cc
+/// \brief Implementation of the B2::SweepRunner class
+
+#include "SweepRunner.hh"
+#include "Monitor.hh"
+#include "ThreadPlacement.hh"
+
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UImanager.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SweepRunner* SweepRunner::Instance()
+{
+  static SweepRunner instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SweepRunner::SetModeratorThicknesses(const G4String& thicknesses)
+{
+  fThicknesses.clear();
+  std::istringstream stream(thicknesses);
+  std::string token;
+  while (stream >> token) {
+    char* end = nullptr;
+    G4double value = std::strtod(token.c_str(), &end);
+    if (*end != '\0' || value < 0.) {
+      G4cout << "-->  WARNING from SweepRunner : ignoring thickness " << token << G4endl;
+      continue;
+    }
+    fThicknesses.push_back(value * mm);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SweepRunner::SetTargetMaterials(const G4String& materials)
+{
+  fMaterials.clear();
+  std::istringstream stream(materials);
+  std::string token;
+  while (stream >> token) fMaterials.push_back(token);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<SweepRunner::Point> SweepRunner::GetPoints() const
+{
+  std::vector<Point> points(1);
+  if ( ! fThicknesses.empty() ) {
+    std::vector<Point> expanded;
+    for (const auto& point : points) {
+      for (auto thickness : fThicknesses) {
+        std::ostringstream value;
+        value << thickness / mm;
+        Point next = point;
+        next.label += (next.label.empty() ? "" : "_") + value.str() + "mm";
+        next.commands.push_back("/B2/det/setModeratorThickness " + value.str() + " mm");
+        expanded.push_back(next);
+      }
+    }
+    points = expanded;
+  }
+  if ( ! fMaterials.empty() ) {
+    std::vector<Point> expanded;
+    for (const auto& point : points) {
+      for (const auto& material : fMaterials) {
+        Point next = point;
+        next.label += (next.label.empty() ? "" : "_") + material;
+        next.commands.push_back("/B2/det/setTargetMaterial " + material);
+        expanded.push_back(next);
+      }
+    }
+    points = expanded;
+  }
+  if (points.size() == 1 && points[0].label.empty()) points.clear();
+  return points;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SweepRunner::BeamOn(G4int nEvents)
+{
+  auto runManager = G4RunManager::GetRunManager();
+  if (runManager->GetRunManagerType() != G4RunManager::sequentialRM) {
+    G4cout << "-->  WARNING from SweepRunner : the sweep forks the process and needs"
+           << " --run-manager serial, nothing is run." << G4endl;
+    return;
+  }
+  if (Monitor::Instance()->IsActive()) {
+    G4cout << "-->  WARNING from SweepRunner : the monitor thread would not survive"
+           << " fork(), set /B2/monitor/port 0 first; nothing is run." << G4endl;
+    return;
+  }
+  std::vector<Point> points = GetPoints();
+  if (points.empty()) {
+    G4cout << "-->  WARNING from SweepRunner : no sweep point, set"
+           << " /B2/sweep/moderatorThickness or /B2/sweep/targetMaterial." << G4endl;
+    return;
+  }
+  std::size_t processes = fProcesses > 0
+    ? fProcesses : ThreadPlacement::Instance()->GetNumberOfAvailableCores();
+
+  using Clock = std::chrono::steady_clock;
+  auto seconds = [](Clock::time_point start) {
+    return std::chrono::duration<G4double>(Clock::now() - start).count();
+  };
+  auto start = Clock::now();
+
+  // Physics tables built once, before the children share them
+  runManager->BeamOn(0);
+  G4double shared = seconds(start);
+
+  // Buffered output would otherwise be written again by every child
+  G4cout << std::flush;
+  std::fflush(nullptr);
+
+  struct Result
+  {
+    Clock::time_point start;
+    G4double seconds = 0.;
+    G4double maxRss = 0.; // MB
+    G4bool ok = false;
+  };
+  std::vector<Result> results(points.size());
+  std::map<pid_t, std::size_t> running;
+  std::size_t next = 0;
+  auto sweepStart = Clock::now();
+
+  while (next < points.size() || ! running.empty()) {
+    while (next < points.size() && running.size() < processes) {
+      results[next].start = Clock::now();
+      pid_t pid = fork();
+      if (pid == 0) RunPoint(points[next], nEvents);
+      if (pid < 0) {
+        G4cout << "-->  WARNING from SweepRunner : cannot fork for point "
+               << points[next].label << G4endl;
+      }
+      else {
+        running[pid] = next;
+      }
+      ++next;
+    }
+    if (running.empty()) break;
+
+    int status = 0;
+    rusage usage{};
+    pid_t pid = wait4(-1, &status, 0, &usage);
+    if (pid < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    auto child = running.find(pid);
+    if (child == running.end()) continue;
+    Result& result = results[child->second];
+    result.seconds = seconds(result.start);
+    result.maxRss = usage.ru_maxrss / 1024.;
+    result.ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    running.erase(child);
+  }
+  G4double wall = seconds(sweepStart);
+
+  auto precision = G4cout.precision();
+  G4cout << G4endl
+         << "--------------------Sweep of " << points.size() << " points in "
+         << std::min(processes, points.size()) << " processes------------" << G4endl
+         << std::left << std::setw(24) << "point" << std::right << std::setw(8) << "status"
+         << std::setw(12) << "wall [s]" << std::setw(12) << "events/s"
+         << std::setw(14) << "max RSS [MB]" << G4endl
+         << std::fixed << std::setprecision(1);
+  G4int failed = 0;
+  for (std::size_t i = 0; i < points.size(); ++i) {
+    const Result& result = results[i];
+    if ( ! result.ok ) ++failed;
+    G4cout << std::left << std::setw(24) << points[i].label << std::right
+           << std::setw(8) << (result.ok ? "ok" : "failed")
+           << std::setw(12) << result.seconds
+           << std::setw(12) << (result.seconds > 0. ? nEvents / result.seconds : 0.)
+           << std::setw(14) << result.maxRss << G4endl;
+  }
+  G4double events = G4double(nEvents) * (points.size() - failed);
+  G4cout << std::left << std::setw(32) << "total" << std::right
+         << std::setw(12) << wall << std::setw(12) << (wall > 0. ? events / wall : 0.)
+         << G4endl
+         << "shared initialisation and physics tables: " << shared << " s" << G4endl
+         << std::defaultfloat << std::setprecision(precision)
+         << "-------------------------------------------------------------" << G4endl;
+  if (failed > 0) {
+    G4cout << "-->  WARNING from SweepRunner : " << failed
+           << " points failed, see their output_*.log" << G4endl;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SweepRunner::RunPoint(const Point& point, G4int nEvents) const
+{
+  // Outputs of the point next to those of a run.sh configuration
+  const char* runId = std::getenv("RUN_ID");
+  std::string identifier = point.label;
+  if (runId) identifier = std::string(runId) + "_" + identifier;
+  setenv("RUN_ID", identifier.c_str(), 1);
+  std::freopen(("output_" + identifier + ".log").c_str(), "w", stdout);
+
+  auto uiManager = G4UImanager::GetUIpointer();
+  G4int status = 0;
+  for (const auto& command : point.commands) {
+    if (status == 0) status = uiManager->ApplyCommand(command);
+  }
+  if (status == 0) status = uiManager->ApplyCommand("/B2/run/beamOn " + std::to_string(nEvents));
+
+  // The outputs are closed at the end of the run; skip the destructors
+  // of the state shared with the parent
+  G4cout << std::flush;
+  std::fflush(nullptr);
+  _exit(status == 0 ? 0 : 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
@@ -0,0 +1,369 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/TallyManager.cc
+/// \brief Implementation of the B2::TallyManager class
+
+#include "TallyManager.hh"
+
+#include "G4AutoLock.hh"
+#include "G4ios.hh"
+
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+namespace B2
+{
+
+G4ThreadLocal TallyManager::ThreadTallies* TallyManager::fgThreadTallies = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TallyManager* TallyManager::Instance()
+{
+  static TallyManager instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TallyManager::AddTally(const G4String& name)
+{
+  G4AutoLock lock(&fMutex);
+  for (std::size_t i = 0; i < fNames.size(); ++i) {
+    if (fNames[i] == name) return G4int(i);
+  }
+  fNames.push_back(name);
+  fSum.push_back(0.);
+  fSum2.push_back(0.);
+  return G4int(fNames.size()) - 1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int TallyManager::GetTallyId(const G4String& name) const
+{
+  for (std::size_t i = 0; i < fNames.size(); ++i) {
+    if (fNames[i] == name) return G4int(i);
+  }
+  return -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::SetStopTallies(const G4String& names)
+{
+  G4AutoLock lock(&fMutex);
+  fStopNames.clear();
+  std::istringstream is(names);
+  G4String name;
+  while (is >> name) fStopNames.push_back(name);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::BeginOfRun()
+{
+  // Every thread resets its own buffers, the master also the merged totals
+  auto tallies = GetThreadTallies();
+  tallies->history.assign(fNames.size(), 0.);
+  tallies->sum.assign(fNames.size(), 0.);
+  tallies->sum2.assign(fNames.size(), 0.);
+  tallies->nHistories = 0;
+  tallies->total.assign(fNames.size(), 0.);
+  tallies->total2.assign(fNames.size(), 0.);
+  tallies->nTotal = 0;
+
+  if ( ! G4Threading::IsMasterThread() ) return;
+
+  G4AutoLock lock(&fMutex);
+  fSum.assign(fNames.size(), 0.);
+  fSum2.assign(fNames.size(), 0.);
+  fNHistories = 0;
+
+  // A resumed run continues from the totals of the earlier segments
+  if ( ! fBaselineSum.empty() ) {
+    fSum = fBaselineSum;
+    fSum2 = fBaselineSum2;
+    fNHistories = fBaselineHistories;
+  }
+  fTimeOffset = fBaselineTime;
+  fBaselineSum.clear();
+  fBaselineSum2.clear();
+  fBaselineHistories = 0;
+  fBaselineTime = 0.;
+
+  // An empty selection or "all" means every tally has to converge
+  fStopIds.clear();
+  for (const auto& name : fStopNames) {
+    if (name == "all") { fStopIds.clear(); break; }
+    G4int id = GetTallyId(name);
+    if (id < 0) {
+      G4cout << "-->  WARNING from TallyManager : tally " << name
+             << " not found, ignored in the stop criterion" << G4endl;
+      continue;
+    }
+    fStopIds.push_back(id);
+  }
+  if (fStopIds.empty()) {
+    for (std::size_t i = 0; i < fNames.size(); ++i) fStopIds.push_back(G4int(i));
+  }
+
+  fStartTime = std::chrono::steady_clock::now();
+  fLastPrint = fTimeOffset;
+  fStopRequested = false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::EndOfRun()
+{
+  Flush(GetThreadTallies());
+
+  if ( ! G4Threading::IsMasterThread() || fNames.empty() ) return;
+
+  G4AutoLock lock(&fMutex);
+  Print("End of run");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::Write(const G4String& fileName) const
+{
+  if (fNames.empty()) return;
+
+  std::ofstream out(fileName);
+  if ( ! out ) {
+    G4cout << "-->  WARNING from TallyManager : cannot write " << fileName << G4endl;
+    return;
+  }
+
+  G4AutoLock lock(&fMutex);
+  out << std::setprecision(std::numeric_limits<G4double>::max_digits10);
+  out << "#class B2::TallyManager\n"
+      << "#elapsed " << GetElapsedTime() << "\n"
+      << "name,histories,sum,sum2,mean,relError\n";
+  for (std::size_t i = 0; i < fNames.size(); ++i) {
+    G4int id = G4int(i);
+    out << fNames[i] << "," << fNHistories << "," << fSum[i] << "," << fSum2[i]
+        << "," << GetMean(id) << "," << GetRelativeError(id) << "\n";
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::Score(G4int id, G4double value)
+{
+  GetThreadTallies()->history[id] += value;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::EndOfHistory()
+{
+  auto tallies = GetThreadTallies();
+  for (std::size_t i = 0; i < tallies->history.size(); ++i) {
+    G4double x = tallies->history[i];
+    tallies->sum[i] += x;
+    tallies->sum2[i] += x * x;
+    tallies->history[i] = 0.;
+  }
+  if (++tallies->nHistories >= fFlushInterval) Flush(tallies);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TallyManager::ThreadTallies* TallyManager::GetThreadTallies()
+{
+  if ( ! fgThreadTallies ) {
+    fgThreadTallies = new ThreadTallies;
+    fgThreadTallies->history.assign(fNames.size(), 0.);
+    fgThreadTallies->sum.assign(fNames.size(), 0.);
+    fgThreadTallies->sum2.assign(fNames.size(), 0.);
+    fgThreadTallies->total.assign(fNames.size(), 0.);
+    fgThreadTallies->total2.assign(fNames.size(), 0.);
+  }
+  return fgThreadTallies;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::Flush(ThreadTallies* tallies)
+{
+  if (tallies->nHistories == 0) return;
+
+  for (std::size_t i = 0; i < tallies->sum.size(); ++i) {
+    tallies->total[i] += tallies->sum[i];
+    tallies->total2[i] += tallies->sum2[i];
+  }
+  tallies->nTotal += tallies->nHistories;
+
+  G4AutoLock lock(&fMutex);
+  for (std::size_t i = 0; i < tallies->sum.size(); ++i) {
+    fSum[i] += tallies->sum[i];
+    fSum2[i] += tallies->sum2[i];
+    tallies->sum[i] = 0.;
+    tallies->sum2[i] = 0.;
+  }
+  fNHistories += tallies->nHistories;
+  tallies->nHistories = 0;
+
+  G4double elapsed = GetElapsedTime();
+  if (fPrintInterval > 0. && elapsed - fLastPrint >= fPrintInterval) {
+    fLastPrint = elapsed;
+    Print("Progress");
+  }
+
+  CheckStopCriteria();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::CheckStopCriteria()
+{
+  if (fStopRequested) return;
+
+  // The budget applies to this run segment only
+  if (fMaxWallTime > 0. && GetElapsedTime() - fTimeOffset >= fMaxWallTime) {
+    G4cout << ">>> Wall-clock budget of " << fMaxWallTime
+           << " s exhausted, stopping the run" << G4endl;
+    fStopRequested = true;
+    return;
+  }
+
+  if (fTargetRelError <= 0. || fStopIds.empty()) return;
+  for (auto id : fStopIds) {
+    G4double relError = GetRelativeError(id);
+    if (relError < 0. || relError > fTargetRelError) return;
+  }
+  G4cout << ">>> All selected tallies reached a relative error below "
+         << fTargetRelError << ", stopping the run" << G4endl;
+  Print("Converged");
+  fStopRequested = true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TallyManager::GetMean(G4int id) const
+{
+  return fNHistories > 0 ? fSum[id] / fNHistories : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TallyManager::GetRelativeError(G4int id) const
+{
+  // Negative while the tally has not scored yet
+  if (fNHistories == 0 || fSum[id] <= 0.) return -1.;
+  G4double var = fSum2[id] / (fSum[id] * fSum[id]) - 1. / fNHistories;
+  return var > 0. ? std::sqrt(var) : 0.;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TallyManager::GetFigureOfMerit(G4int id) const
+{
+  G4double relError = GetRelativeError(id);
+  G4double elapsed = GetElapsedTime();
+  if (relError <= 0. || elapsed <= 0.) return 0.;
+  return 1. / (relError * relError * elapsed);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::GetResults(std::vector<G4double>& mean, std::vector<G4double>& relError,
+                              G4long& nHistories) const
+{
+  G4AutoLock lock(&fMutex);
+  mean.clear();
+  relError.clear();
+  for (std::size_t i = 0; i < fNames.size(); ++i) {
+    mean.push_back(GetMean(G4int(i)));
+    relError.push_back(GetRelativeError(G4int(i)));
+  }
+  nHistories = fNHistories;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double TallyManager::GetElapsedTime() const
+{
+  std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - fStartTime;
+  return fTimeOffset + elapsed.count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::GetThreadTotals(std::vector<G4double>& sum,
+                                   std::vector<G4double>& sum2, G4long& nHistories)
+{
+  auto tallies = GetThreadTallies();
+  Flush(tallies);
+  sum = tallies->total;
+  sum2 = tallies->total2;
+  nHistories = tallies->nTotal;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::SetBaseline(const std::vector<G4double>& sum,
+                               const std::vector<G4double>& sum2,
+                               G4long nHistories, G4double elapsed)
+{
+  G4AutoLock lock(&fMutex);
+  fBaselineSum = sum;
+  fBaselineSum2 = sum2;
+  fBaselineSum.resize(fNames.size(), 0.);
+  fBaselineSum2.resize(fNames.size(), 0.);
+  fBaselineHistories = nHistories;
+  fBaselineTime = elapsed;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TallyManager::Print(const G4String& header) const
+{
+  // Caller holds fMutex
+  auto precision = G4cout.precision();
+  G4cout << ">>> " << header << ": " << fNHistories << " histories in "
+         << std::setprecision(4) << GetElapsedTime() << " s" << G4endl;
+  for (std::size_t i = 0; i < fNames.size(); ++i) {
+    G4int id = G4int(i);
+    G4cout << "    " << std::setw(12) << std::left << fNames[i] << std::right
+           << " mean: " << std::setw(11) << GetMean(id)
+           << " R: " << std::setw(11) << GetRelativeError(id)
+           << " FOM: " << std::setw(11) << GetFigureOfMerit(id) << " 1/s"
+           << G4endl;
+  }
+  G4cout << std::setprecision(precision);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
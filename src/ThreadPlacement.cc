@@ -0,0 +1,180 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/ThreadPlacement.cc
+/// \brief Implementation of the B2::ThreadPlacement class
+
+#include "ThreadPlacement.hh"
+
+#include "G4AutoLock.hh"
+#include "G4ios.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace B2
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ThreadPlacement* ThreadPlacement::Instance()
+{
+  static ThreadPlacement instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ThreadPlacement::ThreadPlacement()
+{
+#ifdef __linux__
+  // Taken before any thread is pinned, so this is what the process was given
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (G4int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) fAllowedCpus.push_back(cpu);
+    }
+  }
+
+  // The node of a CPU shows up as a nodeN entry in its sysfs directory
+  for (G4int cpu : fAllowedCpus) {
+    G4int node = 0;
+    std::error_code error;
+    std::filesystem::path dir("/sys/devices/system/cpu/cpu" + std::to_string(cpu));
+    for (const auto& entry : std::filesystem::directory_iterator(dir, error)) {
+      std::string name = entry.path().filename().string();
+      if (name.size() > 4 && name.compare(0, 4, "node") == 0
+          && std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+        node = std::stoi(name.substr(4));
+        break;
+      }
+    }
+    fCpuNodes.push_back(node);
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int ThreadPlacement::GetNumberOfAvailableCores() const
+{
+  G4int nCores = fAllowedCpus.empty() ? G4Threading::G4GetNumberOfCores()
+                                      : G4int(fAllowedCpus.size());
+
+#ifdef __linux__
+  // A CPU quota of a container limits the usable cores below the affinity
+  G4double quota = -1., period = -1.;
+  std::ifstream cgroup2("/sys/fs/cgroup/cpu.max");
+  std::string value;
+  if (cgroup2 >> value >> period && value != "max") {
+    quota = std::stod(value);
+  }
+  else {
+    std::ifstream quotaFile("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+    std::ifstream periodFile("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+    if ( ! (quotaFile >> quota && periodFile >> period) ) quota = -1.;
+  }
+  if (quota > 0. && period > 0.) {
+    nCores = std::min(nCores, G4int(std::ceil(quota / period)));
+  }
+#endif
+
+  return std::max(nCores, 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ThreadPlacement::PinCurrentThread()
+{
+  G4int threadId = G4Threading::G4GetThreadId();
+  if (fMode == Mode::None || threadId < 0) return;
+
+#ifdef __linux__
+  G4AutoLock lock(&fMutex);
+  const auto& order = GetPlacementOrder();
+  if (order.empty()) return;
+  G4int cpu = order[threadId % order.size()];
+  lock.unlock();
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    G4cout << "-->  WARNING from ThreadPlacement : cannot pin thread " << threadId
+           << " to CPU " << cpu << G4endl;
+  }
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int ThreadPlacement::GetCurrentCpu()
+{
+#ifdef __linux__
+  return sched_getcpu();
+#else
+  return -1;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+const std::vector<G4int>& ThreadPlacement::GetPlacementOrder()
+{
+  if ( ! fOrder.empty() && fOrderMode == fMode ) return fOrder;
+
+  fOrderMode = fMode;
+  if (fMode != Mode::Numa) {
+    fOrder = fAllowedCpus;
+    return fOrder;
+  }
+
+  // Take one CPU of each node in turn
+  std::map<G4int, std::vector<G4int>> nodes;
+  for (std::size_t i = 0; i < fAllowedCpus.size(); ++i) {
+    nodes[fCpuNodes[i]].push_back(fAllowedCpus[i]);
+  }
+  fOrder.clear();
+  for (std::size_t round = 0; fOrder.size() < fAllowedCpus.size(); ++round) {
+    for (const auto& [node, cpus] : nodes) {
+      if (round < cpus.size()) fOrder.push_back(cpus[round]);
+    }
+  }
+  return fOrder;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}
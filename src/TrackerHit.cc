@@ -28,6 +28,8 @@
 /// \brief Implementation of the B2::TrackerHit class
 
 #include "TrackerHit.hh"
+#include "DetectorRegistry.hh"
+
 #include "G4UnitsTable.hh"
 #include "G4VVisManager.hh"
 #include "G4Circle.hh"
@@ -50,6 +52,13 @@ G4bool TrackerHit::operator==(const TrackerHit& right) const
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4String TrackerHit::GetChamberName() const
+{
+  return DetectorRegistry::Instance()->GetName(fChamberNb);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 void TrackerHit::Draw()
 {
   G4VVisManager* pVVisManager = G4VVisManager::GetConcreteInstance();
@@ -72,11 +81,15 @@ void TrackerHit::Print()
   G4cout
      << "  trackID: " << fTrackID
      << " chamberNb: " << fChamberNb
-     << " chamberName: " << fChamberNbToName.at(fChamberNb)
+     << " chamberName: " << GetChamberName()
      << " particleName: " << fParticleName
      << " Edep: " << std::setw(7) << G4BestUnit(fEdep,"Energy")
      << " E: " << std::setw(7) << G4BestUnit(fE,"Energy")
      << " Position: " << std::setw(7) << G4BestUnit( fPos,"Length")
+     << " ExitE: " << std::setw(7) << G4BestUnit(fExitE,"Energy")
+     << " Length: " << std::setw(7) << G4BestUnit(fTrackLength,"Length")
+     << " Steps: " << fNSteps
+     << " Primary: " << fPrimary
      << G4endl;
 }
 
@@ -28,22 +28,29 @@
 /// \brief Implementation of the B2::TrackerSD class
 
 #include "TrackerSD.hh"
+#include "EventTermination.hh"
+#include "PrimaryIndex.hh"
 #include "G4HCofThisEvent.hh"
 #include "G4Step.hh"
 #include "G4VProcess.hh"
 #include "G4ThreeVector.hh"
 #include "G4SDManager.hh"
+#include "G4Neutron.hh"
 #include "G4ios.hh"
 #include "G4SystemOfUnits.hh"
 
 namespace B2
 {
 
+std::atomic<TrackerSD::HitMode> TrackerSD::fgHitMode{TrackerSD::HitMode::Step};
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 TrackerSD::TrackerSD(const G4String& name,
-                     const G4String& hitsCollectionName)
- : G4VSensitiveDetector(name)
+                     const G4String& hitsCollectionName,
+                     G4int detectorNumber)
+ : G4VSensitiveDetector(name),
+   fDetectorNumber(detectorNumber)
 {
   collectionName.insert(hitsCollectionName);
 }
@@ -58,8 +65,16 @@ void TrackerSD::Initialize(G4HCofThisEvent* hce)
 
   // Add this collection in hce
 
-  G4int hcID = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
-  hce->AddHitsCollection( hcID, fHitsCollection );
+  if (fHitsCollectionId < 0) {
+    fHitsCollectionId = G4SDManager::GetSDMpointer()->GetCollectionID(collectionName[0]);
+  }
+  hce->AddHitsCollection( fHitsCollectionId, fHitsCollection );
+
+  fHitMode = fgHitMode;
+  fTrackHits.clear();
+  fLastTrackID = -1;
+  fLastHit = nullptr;
+  fEntered.clear();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -67,32 +82,67 @@ void TrackerSD::Initialize(G4HCofThisEvent* hce)
 G4bool TrackerSD::ProcessHits(G4Step* aStep,
                                      G4TouchableHistory*)
 {
-  auto particleType = aStep->GetTrack()->GetParticleDefinition()->GetParticleName();
-  //G4cout << "Particle type: " << particleType << G4endl;
-  if (particleType != "neutron") return false;
-
-  G4String chamberName = aStep->GetPreStepPoint()->GetTouchable()->GetVolume()->GetName();
-  //G4cout << "Name: " << chamberName << G4endl;
-  if ((chamberName != "Moderator") && (chamberName != "Scorer1") && (chamberName != "BertholdGas")) return false;
-  //G4cout << "passed" << G4endl;
+  // Only neutrons; the volume is the one of this detector
+  auto particle = aStep->GetTrack()->GetParticleDefinition();
+  if (particle != G4Neutron::Definition()) return false;
 
   G4ThreeVector parentPos = aStep->GetPreStepPoint()->GetTouchableHandle()->GetTranslation();
 
   G4double edep = aStep->GetTotalEnergyDeposit();
   G4double e = aStep->GetPreStepPoint()->GetKineticEnergy();
+  G4double exitE = aStep->GetPostStepPoint()->GetKineticEnergy();
   //if (edep==0.) return false;
 
+  // Track mode: further steps of a track update its hit
+  G4int trackID = aStep->GetTrack()->GetTrackID();
+  if (fHitMode == HitMode::Track) {
+    if (trackID != fLastTrackID) {
+      auto it = fTrackHits.find(trackID);
+      fLastHit = (it != fTrackHits.end()) ? it->second : nullptr;
+      fLastTrackID = trackID;
+    }
+    if (fLastHit) {
+      fLastHit->SetEdep(fLastHit->GetEdep() + edep);
+      fLastHit->SetExitE(exitE);
+      fLastHit->SetTrackLength(fLastHit->GetTrackLength() + aStep->GetStepLength());
+      fLastHit->SetNSteps(fLastHit->GetNSteps() + 1);
+      return true;
+    }
+  }
+
   auto newHit = new TrackerHit();
 
-  newHit->SetParticleName(particleType);
-  newHit->SetTrackID(aStep->GetTrack()->GetTrackID());
-  newHit->SetChamberNb(TrackerHit::NameToNb(chamberName));
+  newHit->SetParticleName(particle->GetParticleName());
+  newHit->SetTrackID(trackID);
+  newHit->SetChamberNb(fDetectorNumber);
   newHit->SetEdep(edep);
   newHit->SetE(e);
-  newHit->SetPos(parentPos - aStep->GetPostStepPoint()->GetPosition());
+  newHit->SetExitE(exitE);
+  newHit->SetTrackLength(aStep->GetStepLength());
+  newHit->SetNSteps(1);
+  G4int primary = PrimaryIndex::Instance()->GetPrimary(trackID);
+  newHit->SetPrimary(primary);
+  // A track hit is placed where the track enters the volume, a step hit at
+  // the end of its step
+  auto point = (fHitMode == HitMode::Track) ? aStep->GetPreStepPoint() : aStep->GetPostStepPoint();
+  newHit->SetPos(parentPos - point->GetPosition());
 
   fHitsCollection->insert( newHit );
 
+  if (fHitMode == HitMode::Track) {
+    fTrackHits[trackID] = newHit;
+    fLastHit = newHit;
+  }
+
+  auto termination = EventTermination::Instance();
+  if (termination->IsActive()) {
+    if (primary >= G4int(fEntered.size())) fEntered.resize(primary + 1, false);
+    if ( ! fEntered[primary] ) {
+      fEntered[primary] = true;
+      termination->FirstEntry(aStep->GetTrack());
+    }
+  }
+
   //newHit->Print();
 
   return true;
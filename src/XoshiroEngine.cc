@@ -0,0 +1,308 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file B2/B2b/src/XoshiroEngine.cc
+/// \brief Implementation of the B2::XoshiroEngine class
+
+#include "XoshiroEngine.hh"
+
+#include "CLHEP/Random/engineIDulong.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace B2
+{
+
+namespace
+{
+
+std::uint64_t SplitMix64(std::uint64_t& x)
+{
+  std::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+inline std::uint64_t Rotl(std::uint64_t x, int k)
+{
+  return (x << k) | (x >> (64 - k));
+}
+
+// Upper 52 bits as the mantissa of a double in [1,2), shifted into (0,1)
+inline double ToDouble(std::uint64_t x)
+{
+  std::uint64_t bits = (x >> 12) | 0x3ff0000000000000ULL;
+  double d;
+  std::memcpy(&d, &bits, sizeof(d));
+  return (d - 1.) + 0x1.0p-53;
+}
+
+}  // namespace
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+XoshiroEngine::XoshiroEngine()
+  : XoshiroEngine(19780503L)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+XoshiroEngine::XoshiroEngine(long seed)
+{
+  setSeed(seed, 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void XoshiroEngine::setSeed(long seed, int)
+{
+  long seeds[2] = { seed, 0 };
+  setSeeds(seeds, 1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void XoshiroEngine::setSeeds(const long* seeds, int seedNum)
+{
+  // As MixMax: seedNum seeds, or up to the terminating 0 if seedNum < 1
+  int n = 0;
+  if (seedNum > 0) n = std::min(seedNum, int(kMaxSeeds));
+  else while (n < kMaxSeeds && seeds[n] != 0) ++n;
+
+  std::memset(fSeeds, 0, sizeof(fSeeds));
+  std::memcpy(fSeeds, seeds, n * sizeof(long));
+  theSeed = n > 0 ? seeds[0] : 0;
+  theSeeds = fSeeds;
+
+  // The count is hashed too, so {a} and {a, 0} differ
+  std::uint64_t hash = 0x6a09e667f3bcc909ULL ^ std::uint64_t(n);
+  SplitMix64(hash);
+  for (int i = 0; i < n; ++i) {
+    hash ^= std::uint64_t(seeds[i]);
+    hash = SplitMix64(hash);
+  }
+
+  std::uint64_t words[4 * kLanes];
+  for (auto& word : words) word = SplitMix64(hash);
+  SetState(words, 4 * kLanes);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void XoshiroEngine::SetState(const std::uint64_t* words, std::size_t nWords)
+{
+  for (std::size_t i = 0; i < nWords; ++i) fState[i / kLanes][i % kLanes] = words[i];
+
+  // An all-zero lane would only produce zeros
+  for (int lane = 0; lane < kLanes; ++lane) {
+    if ((fState[0][lane] | fState[1][lane] | fState[2][lane] | fState[3][lane]) == 0) {
+      fState[0][lane] = 0x9e3779b97f4a7c15ULL;
+    }
+  }
+  std::memcpy(fBlockState, fState, sizeof(fState));
+  fIndex = kBufferSize;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void XoshiroEngine::Refill()
+{
+  std::memcpy(fBlockState, fState, sizeof(fState));
+
+  std::uint64_t s0[kLanes], s1[kLanes], s2[kLanes], s3[kLanes];
+  std::memcpy(s0, fState[0], sizeof(s0));
+  std::memcpy(s1, fState[1], sizeof(s1));
+  std::memcpy(s2, fState[2], sizeof(s2));
+  std::memcpy(s3, fState[3], sizeof(s3));
+
+  for (int i = 0; i < kBufferSize; i += kLanes) {
+    for (int lane = 0; lane < kLanes; ++lane) {
+      std::uint64_t result = s0[lane] + s3[lane];
+      std::uint64_t t = s1[lane] << 17;
+      s2[lane] ^= s0[lane];
+      s3[lane] ^= s1[lane];
+      s1[lane] ^= s2[lane];
+      s0[lane] ^= s3[lane];
+      s2[lane] ^= t;
+      s3[lane] = Rotl(s3[lane], 45);
+      fBuffer[i + lane] = ToDouble(result);
+    }
+  }
+
+  std::memcpy(fState[0], s0, sizeof(s0));
+  std::memcpy(fState[1], s1, sizeof(s1));
+  std::memcpy(fState[2], s2, sizeof(s2));
+  std::memcpy(fState[3], s3, sizeof(s3));
+  fIndex = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void XoshiroEngine::flatArray(const int size, double* vect)
+{
+  for (int done = 0; done < size;) {
+    if (fIndex == kBufferSize) Refill();
+    int n = std::min(size - done, kBufferSize - fIndex);
+    std::memcpy(vect + done, fBuffer + fIndex, n * sizeof(double));
+    fIndex += n;
+    done += n;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::ostream& XoshiroEngine::put(std::ostream& os) const
+{
+  os << engineName() << "-begin\n";
+  for (const auto& word : fBlockState) {
+    for (auto lane : word) os << lane << "\n";
+  }
+  os << fIndex << "\n" << engineName() << "-end\n";
+  return os;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::istream& XoshiroEngine::get(std::istream& is)
+{
+  std::string tag;
+  is >> tag;
+  if (tag != engineName() + "-begin") {
+    std::cerr << "XoshiroEngine::get: input is not a " << engineName() << " state" << std::endl;
+    is.clear(std::ios::badbit | is.rdstate());
+    return is;
+  }
+  return getState(is);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::istream& XoshiroEngine::getState(std::istream& is)
+{
+  std::uint64_t words[4 * kLanes];
+  int index = 0;
+  std::string tag;
+  for (auto& word : words) is >> word;
+  is >> index >> tag;
+  if ( ! is || tag != engineName() + "-end" || index < 0 || index > kBufferSize) {
+    std::cerr << "XoshiroEngine::getState: corrupt " << engineName() << " state" << std::endl;
+    is.clear(std::ios::badbit | is.rdstate());
+    return is;
+  }
+
+  // Regenerate the buffer the state was saved in
+  SetState(words, 4 * kLanes);
+  Refill();
+  fIndex = index;
+  return is;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+std::vector<unsigned long> XoshiroEngine::put() const
+{
+  // CLHEP convention: engine id, then 32-bit values
+  std::vector<unsigned long> v;
+  v.push_back(CLHEP::engineIDulong<XoshiroEngine>());
+  for (const auto& word : fBlockState) {
+    for (auto lane : word) {
+      v.push_back(static_cast<unsigned long>(lane & 0xffffffffULL));
+      v.push_back(static_cast<unsigned long>(lane >> 32));
+    }
+  }
+  v.push_back(static_cast<unsigned long>(fIndex));
+  return v;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool XoshiroEngine::get(const std::vector<unsigned long>& v)
+{
+  if (v.empty() || v[0] != CLHEP::engineIDulong<XoshiroEngine>()) {
+    std::cerr << "XoshiroEngine::get: vector is not a " << engineName() << " state" << std::endl;
+    return false;
+  }
+  return getState(v);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+bool XoshiroEngine::getState(const std::vector<unsigned long>& v)
+{
+  if (v.size() != 2 + 8 * kLanes || v.back() > unsigned(kBufferSize)) {
+    std::cerr << "XoshiroEngine::getState: vector has the wrong size" << std::endl;
+    return false;
+  }
+  std::uint64_t words[4 * kLanes];
+  for (int i = 0; i < 4 * kLanes; ++i) {
+    words[i] = (std::uint64_t(v[2 * i + 2] & 0xffffffffUL) << 32) | (v[2 * i + 1] & 0xffffffffUL);
+  }
+  SetState(words, 4 * kLanes);
+  Refill();
+  fIndex = int(v.back());
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void XoshiroEngine::saveStatus(const char filename[]) const
+{
+  std::ofstream out(filename, std::ios::out);
+  if ( ! out ) {
+    std::cerr << "XoshiroEngine::saveStatus: cannot open " << filename << std::endl;
+    return;
+  }
+  put(out);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void XoshiroEngine::restoreStatus(const char filename[])
+{
+  std::ifstream in(filename, std::ios::in);
+  if ( ! in ) {
+    std::cerr << "XoshiroEngine::restoreStatus: cannot open " << filename << std::endl;
+    return;
+  }
+  get(in);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void XoshiroEngine::showStatus() const
+{
+  std::cout << "--------- " << engineName() << " status ---------" << std::endl;
+  put(std::cout);
+  std::cout << "----------------------------------------" << std::endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+}